@@ -0,0 +1,270 @@
+/* This software is released under the BSD License.
+ |
+ | Copyright (c) 2015, Kevin P. Barry [ta0kira@gmail.com]
+ | All rights reserved.
+ |
+ | Redistribution  and  use  in  source  and   binary  forms,  with  or  without
+ | modification, are permitted provided that the following conditions are met:
+ |
+ | - Redistributions of source code must retain the above copyright notice, this
+ |   list of conditions and the following disclaimer.
+ |
+ | - Redistributions in binary  form must reproduce the  above copyright notice,
+ |   this list  of conditions and the following disclaimer in  the documentation
+ |   and/or other materials provided with the distribution.
+ |
+ | - Neither the name  of the  Locking Container Project  nor  the names  of its
+ |   contributors may be  used to endorse or promote products  derived from this
+ |   software without specific prior written permission.
+ |
+ | THIS SOFTWARE IS  PROVIDED BY THE COPYRIGHT HOLDERS AND  CONTRIBUTORS "AS IS"
+ | AND ANY  EXPRESS OR IMPLIED  WARRANTIES,  INCLUDING, BUT  NOT LIMITED TO, THE
+ | IMPLIED WARRANTIES OF  MERCHANTABILITY  AND FITNESS FOR A  PARTICULAR PURPOSE
+ | ARE DISCLAIMED.  IN  NO EVENT SHALL  THE COPYRIGHT  OWNER  OR CONTRIBUTORS BE
+ | LIABLE  FOR  ANY  DIRECT,   INDIRECT,  INCIDENTAL,   SPECIAL,  EXEMPLARY,  OR
+ | CONSEQUENTIAL   DAMAGES  (INCLUDING,  BUT  NOT  LIMITED  TO,  PROCUREMENT  OF
+ | SUBSTITUTE GOODS OR SERVICES;  LOSS  OF USE,  DATA,  OR PROFITS;  OR BUSINESS
+ | INTERRUPTION)  HOWEVER  CAUSED  AND ON  ANY  THEORY OF LIABILITY,  WHETHER IN
+ | CONTRACT,  STRICT  LIABILITY, OR  TORT (INCLUDING  NEGLIGENCE  OR  OTHERWISE)
+ | ARISING IN ANY  WAY OUT OF  THE USE OF THIS SOFTWARE, EVEN  IF ADVISED OF THE
+ | POSSIBILITY OF SUCH DAMAGE.
+ +~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~*/
+
+#ifndef lc_async_container_hpp
+#define lc_async_container_hpp
+
+#include "locking-container.hpp"
+
+//NOTE: everything in this header is opt-in: it requires C++20 coroutines, so
+//it's gated behind LC_ENABLE_COROUTINES to keep the C++11 build of the rest
+//of the library untouched. Define that macro (and compile with -std=c++20 or
+//later) to use async_locking_container.
+
+#ifdef LC_ENABLE_COROUTINES
+
+#include <coroutine>
+#include <deque>
+
+namespace lc {
+
+
+/*! \class async_rw_lock
+ *  \brief \ref rw_lock variant that can suspend coroutines instead of
+ *  blocking threads.
+ *
+ * This lock behaves exactly like \ref rw_lock for the ordinary (thread
+ * blocking) interface. In addition, a coroutine can request the lock via
+ * \ref acquire_or_enqueue: if the lock can't be obtained immediately, the
+ * coroutine's handle is placed in a FIFO waiter queue instead of blocking the
+ * calling thread, and the unlock path grants the lock to (and resumes) as
+ * many queued waiters as can hold it concurrently.
+ * \attention Resumed coroutines run on the thread that released the lock;
+ * coroutines that must run on a particular executor need to reschedule
+ * themselves after resuming.
+ */
+
+class async_rw_lock : public rw_lock {
+public:
+  using rw_lock::count_type;
+
+  async_rw_lock() {}
+
+private:
+  async_rw_lock(const async_rw_lock&);
+  async_rw_lock &operator = (const async_rw_lock&);
+
+public:
+  count_type unlock(lock_auth_base *auth, bool read, bool test = false) {
+    count_type result = this->rw_lock::unlock(auth, read, test);
+    if (result >= 0) this->grant_waiters();
+    return result;
+  }
+
+  /*! \brief Obtain the lock for a coroutine, or queue it for resumption.
+   *
+   * Makes a non-blocking lock attempt on behalf of the coroutine; on failure
+   * the handle is queued and resumed once the lock has been granted to it by
+   * some unlock. The auth., if any, is registered by whichever thread grants
+   * the lock, so it must not be used concurrently by other coroutines — use
+   * one auth. per coroutine, not the per-thread cached one.
+   *
+   * \return whether the coroutine needs to suspend (i.e., the lock was not
+   * obtained immediately)
+   */
+  bool acquire_or_enqueue(lock_auth_base *auth, bool read, std::coroutine_handle <> handle) {
+    std::lock_guard <std::mutex> local_lock(queue_lock);
+    //(holding 'queue_lock' for the attempt closes the race against an unlock
+    //that drains the queue between a failed attempt and the enqueue)
+    if (this->rw_lock::lock(auth, read, false) >= 0) return false;
+    waiters.push_back(waiter {handle, auth, read});
+    return true;
+  }
+
+private:
+  void grant_waiters() {
+    std::deque <std::coroutine_handle <> > ready;
+    {
+      std::lock_guard <std::mutex> local_lock(queue_lock);
+      //grant in FIFO order until a waiter can't be accommodated; a run of
+      //readers at the front is granted as a batch, since the non-blocking
+      //attempts succeed together
+      while (!waiters.empty()) {
+        waiter &front = waiters.front();
+        if (this->rw_lock::lock(front.auth, front.read, false) < 0) break;
+        ready.push_back(front.handle);
+        waiters.pop_front();
+      }
+    }
+    //(resume outside of 'queue_lock' so resumed coroutines can lock and
+    //unlock freely)
+    for (auto &handle : ready) handle.resume();
+  }
+
+  struct waiter {
+    std::coroutine_handle <>  handle;
+    lock_auth_base           *auth;
+    bool                      read;
+  };
+
+  std::mutex           queue_lock;
+  std::deque <waiter>  waiters;
+};
+
+template <>
+class lock_auth <async_rw_lock> : public lock_auth_rw_lock {};
+
+
+/*! \class async_locking_container
+ *  \brief Container with co_await-able lock acquisition.
+ *
+ * This is a \ref locking_container whose lock additionally supports suspending
+ * coroutines: 'co_await container.async_get_write()' yields a \ref
+ * object_proxy exactly like \ref locking_container_base::get_write, but a
+ * contended acquisition suspends the awaiting coroutine instead of blocking
+ * the executor thread carrying it. All of the ordinary (blocking) accessors
+ * remain available and interoperate with the queued waiters.
+ */
+
+template <class Type>
+class async_locking_container : public locking_container <Type, async_rw_lock> {
+public:
+  typedef locking_container <Type, async_rw_lock> base;
+  using typename base::type;
+  using typename base::write_proxy;
+  using typename base::read_proxy;
+  using typename base::auth_type;
+
+  /*! \brief Constructor.*/
+  explicit async_locking_container() {}
+
+  /*! \brief Constructor.
+   *
+   * \param object object to copy as contained object.
+   */
+  explicit async_locking_container(const type &object) : base(object) {}
+
+  /*! Awaitable returned by \ref async_get_write.*/
+  class write_awaitable {
+  public:
+    write_awaitable(async_locking_container *new_container, lock_auth_base *new_auth) :
+      container(new_container), auth(new_auth) {}
+
+    bool await_ready() const {
+      //(the lock attempt is made in 'await_suspend')
+      return false;
+    }
+
+    bool await_suspend(std::coroutine_handle <> handle) {
+      return container->locks.acquire_or_enqueue(auth, false, handle);
+    }
+
+    write_proxy await_resume() {
+      //(the lock is held on resumption; hand it to the proxy)
+      return container->adopt_write_lock(auth);
+    }
+
+  private:
+    async_locking_container *container;
+    lock_auth_base          *auth;
+  };
+
+  /*! Awaitable returned by \ref async_get_read.*/
+  class read_awaitable {
+  public:
+    read_awaitable(async_locking_container *new_container, lock_auth_base *new_auth) :
+      container(new_container), auth(new_auth) {}
+
+    bool await_ready() const {
+      return false;
+    }
+
+    bool await_suspend(std::coroutine_handle <> handle) {
+      return container->locks.acquire_or_enqueue(auth, true, handle);
+    }
+
+    read_proxy await_resume() {
+      return container->adopt_read_lock(auth);
+    }
+
+  private:
+    async_locking_container *container;
+    lock_auth_base          *auth;
+  };
+
+  /*! \brief Obtain a writable proxy, suspending the coroutine if necessary.
+   *
+   * @see locking_container_base::get_write
+   *
+   * \return awaitable yielding a proxy object
+   */
+  write_awaitable async_get_write() {
+    return write_awaitable(this, NULL);
+  }
+
+  /*! \brief Obtain a writable proxy, suspending the coroutine if necessary
+   *  and using deadlock prevention.
+   *
+   * \attention The auth. is registered by whichever thread grants the lock;
+   * use one auth. per coroutine rather than one per thread.
+   *
+   * @see locking_container_base::get_write_auth
+   * \param auth Authorization object to prevent deadlocks.
+   *
+   * \return awaitable yielding a proxy object
+   */
+  write_awaitable async_get_write_auth(auth_type &auth) {
+    return write_awaitable(this, auth.get());
+  }
+
+  /*! \brief Obtain a read-only proxy, suspending the coroutine if necessary.
+   *
+   * @see locking_container_base::get_read
+   *
+   * \return awaitable yielding a proxy object
+   */
+  read_awaitable async_get_read() {
+    return read_awaitable(this, NULL);
+  }
+
+  /*! \brief Obtain a read-only proxy, suspending the coroutine if necessary
+   *  and using deadlock prevention.
+   *
+   * @see async_get_write_auth
+   * \param auth Authorization object to prevent deadlocks.
+   *
+   * \return awaitable yielding a proxy object
+   */
+  read_awaitable async_get_read_auth(auth_type &auth) {
+    return read_awaitable(this, auth.get());
+  }
+
+private:
+  async_locking_container(const async_locking_container&);
+  async_locking_container &operator = (const async_locking_container&);
+};
+
+} //namespace lc
+
+#endif //LC_ENABLE_COROUTINES
+
+#endif //lc_async_container_hpp
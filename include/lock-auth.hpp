@@ -33,6 +33,7 @@
 #ifndef lc_authorization_hpp
 #define lc_authorization_hpp
 
+#include <atomic>
 #include <set>
 
 #include <assert.h>
@@ -211,6 +212,23 @@ class rw_lock;
 template <>
 class lock_auth <rw_lock> : public lock_auth_rw_lock {};
 
+class fast_rw_lock;
+
+template <>
+class lock_auth <fast_rw_lock> : public lock_auth_rw_lock {};
+
+class sharded_rw_lock;
+
+template <>
+class lock_auth <sharded_rw_lock> : public lock_auth_rw_lock {};
+
+template <class> class policy_rw_lock;
+
+//NOTE: the fairness policy changes who waits, not what combinations of locks
+//are safe to hold, so rw_lock rules apply to every policy
+template <class Policy>
+class lock_auth <policy_rw_lock <Policy> > : public lock_auth_rw_lock {};
+
 
 /*! \class lock_auth_r_lock
  *
@@ -293,6 +311,12 @@ class w_lock;
 template <>
 class lock_auth <w_lock> : public lock_auth_w_lock {};
 
+//NOTE: seq_lock only grants write locks, so w_lock rules apply
+class seq_lock;
+
+template <>
+class lock_auth <seq_lock> : public lock_auth_w_lock {};
+
 
 /*! \class lock_auth_dumb_lock
  *
@@ -433,6 +457,9 @@ template <class> class ordered_lock;
 template <>
 class lock_auth <ordered_lock <rw_lock> > : public lock_auth_ordered_lock <rw_lock> {};
 
+template <>
+class lock_auth <ordered_lock <fast_rw_lock> > : public lock_auth_ordered_lock <fast_rw_lock> {};
+
 template <>
 class lock_auth <ordered_lock <r_lock> > : public lock_auth_ordered_lock <r_lock> {};
 
@@ -443,11 +470,210 @@ class lock_auth <ordered_lock <w_lock> > : public lock_auth_ordered_lock <w_lock
 template <>
 class lock_auth <ordered_lock <dumb_lock> > : public lock_auth_ordered_lock <dumb_lock> {};
 
+/*! \class lock_auth_static_ordered_lock
+ *
+ * This auth. type is the counterpart of lock_auth_ordered_lock for locks whose
+ * order is fixed at compile time (see static_ordered_lock). Because the strict
+ * locking order is validated by static_asserts rather than at runtime, this
+ * auth. keeps no record of the orders it holds: ordered locks are simply
+ * authorized without the 'lock_out'/'must_block' restrictions. If at any time
+ * this auth. obtains a lock on an unordered container, deadlock prevention
+ * reverts to that of the base auth. type until that lock is released.
+ * \attention This auth. trusts the caller to respect ascending order for locks
+ * it can't check at compile time (i.e., acquisitions made by hand rather than
+ * through get_two_locks/get_all_locks).
+ */
+
+template <class Type>
+class lock_auth_static_ordered_lock : public lock_auth <Type> {
+private:
+  typedef lock_auth <Type> base;
+
+public:
+  using typename base::count_type;
+  using typename base::order_type;
+
+  lock_auth_static_ordered_lock() : unordered_locks(0) {}
+
+  ~lock_auth_static_ordered_lock() {
+    assert(!unordered_locks);
+  }
+
+private:
+  lock_auth_static_ordered_lock(const lock_auth_static_ordered_lock&);
+  lock_auth_static_ordered_lock &operator = (const lock_auth_static_ordered_lock&);
+
+protected:
+  bool order_allowed(order_type /*order*/) const {
+    return true;
+  }
+
+  bool register_auth(lock_data &l) {
+    if (!this->base::register_auth(l)) return false;
+    if (!l.order) {
+      ++unordered_locks;
+      assert(unordered_locks);
+    }
+    return true;
+  }
+
+  bool test_auth(lock_data &l) const {
+    //use the normal rules if an unordered lock "taints" this auth.
+    bool normal_rules = !l.order || unordered_locks;
+    //(if order rules are respected, 'lock_out' and 'must_block' aren't needed;
+    //cf. 'lock_auth_ordered_lock')
+    if (normal_rules) {
+      l.lock_out = l.must_block;
+    } else {
+      l.lock_out   = false;
+      l.must_block = false;
+    }
+    return this->base::test_auth(l);
+  }
+
+  void release_auth(unlock_data &l) {
+    if (!l.order) {
+      assert(unordered_locks);
+      --unordered_locks;
+    }
+    this->base::release_auth(l);
+  }
+
+private:
+  count_type unordered_locks;
+};
+
+template <class, lock_auth_base::order_type> class static_ordered_lock;
+
+template <class Base, lock_auth_base::order_type Order>
+class lock_auth <static_ordered_lock <Base, Order> > :
+  public lock_auth_static_ordered_lock <Base> {};
+
+template <class> class instrumented_lock;
+
+//NOTE: instrumentation doesn't change locking semantics; an instrumented lock
+//uses whatever auth. type its base lock uses
+template <class Base>
+class lock_auth <instrumented_lock <Base> > : public lock_auth <Base> {};
+
+template <class> class padded_lock;
+
+//NOTE: padding doesn't change locking semantics; a padded lock uses whatever
+//auth. type its base lock uses
+template <class Base>
+class lock_auth <padded_lock <Base> > : public lock_auth <Base> {};
+
+
+/*! \class lock_auth_detecting
+ *
+ * This auth. type prevents deadlocks by detection rather than by restriction:
+ * it maintains a process-wide wait-for graph of the locks held and waited for
+ * by every lock_auth_detecting in the process, and it only rejects an
+ * acquisition if blocking for it would close a cycle in that graph. Unlike
+ * lock_auth_rw_lock, this allows the caller to hold any combination of read
+ * and write locks at once — like multi-locking, but without funneling every
+ * acquisition through a single \ref meta_lock — and unlike
+ * lock_auth_ordered_lock, it doesn't require assigning orders to containers.
+ * Orders are ignored, so it can also be used with ordered containers.
+ * \attention The graph only sees threads that use lock_auth_detecting: every
+ * thread that locks a container shared with this auth. type must also use it,
+ * or its waits are invisible and deadlocks can slip through.
+ * \attention Detection is conservative. The graph doesn't know when a blocked
+ * thread has been granted its lock (only when it next locks or unlocks
+ * something), and it treats all of a read-shared lock's holders as blocking
+ * its waiters; both can cause a safe acquisition to be rejected, but neither
+ * causes a true cycle to be missed.
+ */
+
+class lock_auth_detecting : public lock_auth_base {
+public:
+  using lock_auth_base::count_type;
+  using lock_auth_base::order_type;
+
+  lock_auth_detecting();
+
+  count_type reading_count() const;
+  count_type writing_count() const;
+
+  ~lock_auth_detecting();
+
+private:
+  lock_auth_detecting(const lock_auth_detecting&);
+  lock_auth_detecting &operator = (const lock_auth_detecting&);
+
+protected:
+  bool register_auth(lock_data &l);
+  bool test_auth(lock_data &l) const;
+  void release_auth(unlock_data &l);
+
+  bool order_allowed(order_type order) const;
+
+private:
+  //(edits to the process-wide holder table, sharded by lock identity)
+  static void record_hold(const void *lock, const lock_auth_detecting *auth);
+  static void erase_hold(const void *lock, const lock_auth_detecting *auth);
+
+  /*! Would blocking on 'lock' create a cycle back to a lock this auth. holds?*/
+  bool closes_cycle(const void *lock) const;
+
+  count_type reading, writing;
+  //(the lock this auth. is — or was most recently — blocked waiting for; read
+  //by other threads' cycle checks, hence atomic)
+  std::atomic <const void*> waiting_for;
+};
+
 
 /*! An authorization type that should be acceptable for use with all lock types.*/
 typedef lock_auth <ordered_lock <rw_lock> > lock_auth_max;
 
 
+/*! \brief Get the calling thread's cached authorization object.
+ *
+ * This lazily creates one auth. object per thread per auth. type and caches it
+ * in thread-local storage, so threads created in bursts don't pay for a heap
+ * allocation per auth., and passing the raw pointer to the non-owning accessor
+ * overloads (e.g., \ref locking_container_base::get_write_auth) avoids the
+ * shared-pointer reference counting of \ref locking_container::new_auth.
+ * \attention The returned object is destructed at thread exit; as with any
+ * auth., all locks must be released by then.
+ * \attention Because the auth. is shared by everything on the thread using
+ * this accessor, its lock bookkeeping spans all of them, which is exactly what
+ * deadlock prevention needs — but don't pass it to another thread.
+ */
+template <class Auth = lock_auth_max>
+Auth *current_thread_auth() {
+  thread_local Auth cached;
+  return &cached;
+}
+
+
+/*! \class lock_auth_null_lock
+ *
+ * This auth. type allows everything and records nothing, matching the
+ * non-locking behavior of \ref null_lock. It performs no deadlock prevention.
+ */
+
+//NOTE: defined inline, like null_lock, so that the auth. round-trip also
+//compiles away
+
+class lock_auth_null_lock : public lock_auth_base {
+public:
+  using lock_auth_base::count_type;
+  using lock_auth_base::order_type;
+
+protected:
+  bool register_auth(lock_data& /*l*/)     { return true; }
+  bool test_auth(lock_data& /*l*/) const   { return true; }
+  void release_auth(unlock_data& /*l*/)    {}
+  bool order_allowed(order_type /*order*/) const { return true; }
+};
+
+class null_lock;
+
+template <>
+class lock_auth <null_lock> : public lock_auth_null_lock {};
+
+
 /*! \class lock_auth_broken_lock
  *
  * This auth. type doesn't allow the caller to obtain any locks.
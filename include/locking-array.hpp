@@ -0,0 +1,253 @@
+/* This software is released under the BSD License.
+ |
+ | Copyright (c) 2015, Kevin P. Barry [ta0kira@gmail.com]
+ | All rights reserved.
+ |
+ | Redistribution  and  use  in  source  and   binary  forms,  with  or  without
+ | modification, are permitted provided that the following conditions are met:
+ |
+ | - Redistributions of source code must retain the above copyright notice, this
+ |   list of conditions and the following disclaimer.
+ |
+ | - Redistributions in binary  form must reproduce the  above copyright notice,
+ |   this list  of conditions and the following disclaimer in  the documentation
+ |   and/or other materials provided with the distribution.
+ |
+ | - Neither the name  of the  Locking Container Project  nor  the names  of its
+ |   contributors may be  used to endorse or promote products  derived from this
+ |   software without specific prior written permission.
+ |
+ | THIS SOFTWARE IS  PROVIDED BY THE COPYRIGHT HOLDERS AND  CONTRIBUTORS "AS IS"
+ | AND ANY  EXPRESS OR IMPLIED  WARRANTIES,  INCLUDING, BUT  NOT LIMITED TO, THE
+ | IMPLIED WARRANTIES OF  MERCHANTABILITY  AND FITNESS FOR A  PARTICULAR PURPOSE
+ | ARE DISCLAIMED.  IN  NO EVENT SHALL  THE COPYRIGHT  OWNER  OR CONTRIBUTORS BE
+ | LIABLE  FOR  ANY  DIRECT,   INDIRECT,  INCIDENTAL,   SPECIAL,  EXEMPLARY,  OR
+ | CONSEQUENTIAL   DAMAGES  (INCLUDING,  BUT  NOT  LIMITED  TO,  PROCUREMENT  OF
+ | SUBSTITUTE GOODS OR SERVICES;  LOSS  OF USE,  DATA,  OR PROFITS;  OR BUSINESS
+ | INTERRUPTION)  HOWEVER  CAUSED  AND ON  ANY  THEORY OF LIABILITY,  WHETHER IN
+ | CONTRACT,  STRICT  LIABILITY, OR  TORT (INCLUDING  NEGLIGENCE  OR  OTHERWISE)
+ | ARISING IN ANY  WAY OUT OF  THE USE OF THIS SOFTWARE, EVEN  IF ADVISED OF THE
+ | POSSIBILITY OF SUCH DAMAGE.
+ +~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~*/
+
+#ifndef lc_locking_array_hpp
+#define lc_locking_array_hpp
+
+#include <new>
+
+#include "locking-container.hpp"
+
+namespace lc {
+
+
+//(selects the per-element lock construction in locking_array: ordered element
+//locks get an order derived from their index; everything else is
+//default-constructed)
+
+template <class Lock>
+struct array_element_ordered : std::false_type {};
+
+template <class Base>
+struct array_element_ordered <ordered_lock <Base> > : std::true_type {};
+
+
+/*! \class locking_array
+ *  \brief Fixed-size array of individually-locked elements with contiguous
+ *  payload storage.
+ *
+ * This container protects N elements of the same type, each with its own
+ * lock, like N separate \ref locking_container objects — but the payloads are
+ * stored contiguously (the base of the payload array is cache-line aligned)
+ * in one allocation, with the locks in a parallel array, so traversals stream
+ * memory instead of chasing per-node heap pointers. The locks are padded to
+ * \ref cache_line_size so neighboring elements don't share lock cache lines.
+ * The indexed accessors return the same proxy types as \ref
+ * locking_container, with the same auth. and multi-lock machinery.
+ *
+ * If 'Lock' is an \ref ordered_lock, each element's lock is constructed with
+ * order 'first_order + index', so multiple elements can be acquired with an
+ * ordered auth. by locking them in ascending index order — no global \ref
+ * meta_lock needed. For any other lock type 'first_order' must be 0.
+ * \attention The array itself (its size and storage) is not protected; only
+ * the elements are. Resizing isn't supported for that reason.
+ */
+
+template <class Type, class Lock = rw_lock>
+class locking_array {
+public:
+  typedef Type                        type;
+  typedef padded_lock <Lock>          lock_type;
+  typedef object_proxy <type>         write_proxy;
+  typedef object_proxy <const type>   read_proxy;
+  typedef lock_auth_base::auth_type   auth_type;
+  typedef lock_auth_base::order_type  order_type;
+  typedef lock_auth <lock_type>       auth_base_type;
+
+  /*! \brief Constructor.
+   *
+   * \param new_size Number of elements; fixed for the container's lifetime.
+   * \param initial Value to copy into every element.
+   * \param first_order Order of element 0's lock (ordered 'Lock' types only);
+   * element i gets order 'first_order + i'.
+   */
+  explicit locking_array(std::size_t new_size, const type &initial = type(),
+    order_type first_order = 0) : array_size(new_size),
+    value_buffer(new_size * sizeof(type) + cache_line_size),
+    lock_buffer(new_size * sizeof(lock_type) + cache_line_size),
+    values((type*) align_base(value_buffer)),
+    locks((lock_type*) align_base(lock_buffer)) {
+    assert(!first_order || array_element_ordered <Lock> ::value);
+    for (std::size_t i = 0; i < array_size; i++) {
+      new (values + i) type(initial);
+      construct_lock(locks + i, first_order + (order_type) i,
+        array_element_ordered <Lock> ());
+    }
+  }
+
+  ~locking_array() {
+    for (std::size_t i = 0; i < array_size; i++) {
+      locks[array_size - 1 - i].~lock_type();
+      values[array_size - 1 - i].~type();
+    }
+  }
+
+private:
+  locking_array(const locking_array&);
+  locking_array &operator = (const locking_array&);
+
+public:
+  /** @name Element Access
+   *
+   */
+  //@{
+
+  /*! Number of elements.*/
+  std::size_t size() const {
+    return array_size;
+  }
+
+  /*! \brief Retrieve a writable proxy to an element.
+   *
+   * @see locking_container_base::get_write
+   * \param index Element to lock; must be < \ref size.
+   * \param block Should the call block for a lock?
+   *
+   * \return proxy object
+   */
+  inline write_proxy get_write(std::size_t index, bool block = true) {
+    return this->write_multi(index, NULL, NULL, block);
+  }
+
+  /*! \brief Retrieve a read-only proxy to an element.
+   *
+   * @see get_write
+   */
+  inline read_proxy get_read(std::size_t index, bool block = true) {
+    return this->read_multi(index, NULL, NULL, block);
+  }
+
+  /*! \brief Retrieve a writable proxy to an element using deadlock
+   *  prevention.
+   *
+   * @see locking_container_base::get_write_auth
+   */
+  inline write_proxy get_write_auth(std::size_t index, auth_type &auth, bool block = true) {
+    if (!auth) return write_proxy();
+    return this->write_multi(index, NULL, auth.get(), block);
+  }
+
+  /*! \brief Retrieve a read-only proxy to an element using deadlock
+   *  prevention.
+   *
+   * @see locking_container_base::get_read_auth
+   */
+  inline read_proxy get_read_auth(std::size_t index, auth_type &auth, bool block = true) {
+    if (!auth) return read_proxy();
+    return this->read_multi(index, NULL, auth.get(), block);
+  }
+
+  /*! \brief Retrieve a writable proxy to an element using deadlock prevention
+   *  and multiple locking functionality.
+   *
+   * @see locking_container_base::get_write_multi
+   */
+  inline write_proxy get_write_multi(std::size_t index, meta_lock_base &meta_lock,
+    auth_type &auth, bool block = true) {
+    if (!auth) return write_proxy();
+    return this->write_multi(index, meta_lock.get_lock_object(), auth.get(), block);
+  }
+
+  /*! \brief Retrieve a read-only proxy to an element using deadlock
+   *  prevention and multiple locking functionality.
+   *
+   * @see locking_container_base::get_read_multi
+   */
+  inline read_proxy get_read_multi(std::size_t index, meta_lock_base &meta_lock,
+    auth_type &auth, bool block = true) {
+    if (!auth) return read_proxy();
+    return this->read_multi(index, meta_lock.get_lock_object(), auth.get(), block);
+  }
+
+  //@}
+
+  /** @name Authorization
+   *
+   */
+  //@{
+
+  /*! Get a new authorization object.*/
+  auth_type get_new_auth() const {
+    return locking_array::new_auth();
+  }
+
+  /*! Get a new authorization object.*/
+  static auth_type new_auth() {
+    return auth_type(new auth_base_type);
+  }
+
+  /*! Get an element's order.*/
+  order_type get_order(std::size_t index) const {
+    assert(index < array_size);
+    return locks[index].get_order();
+  }
+
+  //@}
+
+private:
+  inline write_proxy write_multi(std::size_t index, lock_base *meta_lock,
+    lock_auth_base *auth, bool block) {
+    assert(index < array_size);
+    return write_proxy(values + index, locks + index, auth, false, block, meta_lock);
+  }
+
+  inline read_proxy read_multi(std::size_t index, lock_base *meta_lock,
+    lock_auth_base *auth, bool block) {
+    assert(index < array_size);
+    return read_proxy(values + index, locks + index, auth, true, block, meta_lock);
+  }
+
+  //(the buffers are over-allocated by one cache line so the arrays can start
+  //on a cache-line boundary regardless of where the allocation landed)
+  static char *align_base(std::vector <char> &buffer) {
+    char *base = &buffer[0];
+    const std::size_t extra = (std::size_t) base % cache_line_size;
+    return extra? base + (cache_line_size - extra) : base;
+  }
+
+  static void construct_lock(lock_type *lock, order_type order, std::true_type) {
+    new (lock) lock_type(order);
+  }
+
+  static void construct_lock(lock_type *lock, order_type /*order*/, std::false_type) {
+    new (lock) lock_type;
+  }
+
+  const std::size_t  array_size;
+  std::vector <char> value_buffer, lock_buffer;
+  type              *values;
+  lock_type         *locks;
+};
+
+} //namespace lc
+
+#endif //lc_locking_array_hpp
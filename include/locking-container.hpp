@@ -91,7 +91,14 @@
 #ifndef lc_locking_container_hpp
 #define lc_locking_container_hpp
 
+#include <algorithm>
+#include <memory>
+#include <thread>
 #include <utility>
+#include <type_traits>
+#include <vector>
+
+#include <string.h>
 
 #include "locks.hpp"
 #include "lock-auth.hpp"
@@ -113,11 +120,16 @@ namespace lc {
 template <class Type>
 class locking_container_base {
 public:
-  typedef Type                       type;
-  typedef object_proxy <type>        write_proxy;
-  typedef object_proxy <const type>  read_proxy;
+  typedef Type                              type;
+  typedef object_proxy <type>               write_proxy;
+  typedef object_proxy <const type>         read_proxy;
+  typedef unique_object_proxy <type>        unique_write_proxy;
+  typedef unique_object_proxy <const type>  unique_read_proxy;
   typedef lock_auth_base::auth_type  auth_type;
   typedef lock_auth_base::order_type order_type;
+  typedef lock_auth_base::count_type count_type;
+  //(the clock used for the timed accessor functions)
+  typedef std::chrono::steady_clock  clock_type;
 
   /** @name Accessor Functions
    *
@@ -211,6 +223,199 @@ public:
 
   //@}
 
+  /** @name Non-owning Accessor Functions
+   *
+   * These overloads take a raw authorization pointer instead of a shared
+   * pointer, so no reference count is touched on the lock fast path. The
+   * caller must keep the auth. object alive while any returned proxy exists;
+   * \ref current_thread_auth provides a suitably long-lived one.
+   */
+  //@{
+
+  /*! \brief Retrieve a writable proxy to the contained object using deadlock
+   *  prevention.
+   *
+   * @see get_write_auth
+   * \param auth Authorization object to prevent deadlocks (not owned).
+   * \param block Should the call block for a lock?
+   *
+   * \return proxy object
+   */
+  virtual write_proxy get_write_auth(lock_auth_base *auth, bool block) = 0;
+
+  /*! \brief Retrieve a read-only proxy to the contained object using deadlock
+   *  prevention.
+   *
+   * @see get_read_auth
+   * \param auth Authorization object to prevent deadlocks (not owned).
+   * \param block Should the call block for a lock?
+   *
+   * \return proxy object
+   */
+  virtual read_proxy get_read_auth(lock_auth_base *auth, bool block) = 0;
+
+  //@}
+
+  /** @name Timed Accessor Functions
+   *
+   * These variants wait for a lock until a deadline ('_until', a
+   * \ref clock_type time point) or for a timeout ('_for', any
+   * 'std::chrono::duration'), then give up and return an empty proxy, so
+   * latency-bound callers can take a fallback path instead of blocking
+   * indefinitely or spinning on non-blocking attempts.
+   */
+  //@{
+
+  /*! \brief Retrieve a writable proxy to the contained object, waiting no
+   *  later than the deadline.
+   *
+   * @see get_write
+   * \param deadline When to give up waiting for the lock.
+   *
+   * \return proxy object
+   */
+  inline write_proxy get_write_until(clock_type::time_point deadline) {
+    return this->get_write_auth_until((lock_auth_base*) NULL, deadline);
+  }
+
+  /*! \brief Retrieve a read-only proxy to the contained object, waiting no
+   *  later than the deadline.
+   *
+   * @see get_write_until
+   * \param deadline When to give up waiting for the lock.
+   *
+   * \return proxy object
+   */
+  inline read_proxy get_read_until(clock_type::time_point deadline) {
+    return this->get_read_auth_until((lock_auth_base*) NULL, deadline);
+  }
+
+  /*! \brief Retrieve a writable proxy to the contained object, waiting at
+   *  most for the timeout given.
+   *
+   * @see get_write_until
+   * \param timeout How long to wait for the lock.
+   *
+   * \return proxy object
+   */
+  template <class Rep, class Period>
+  inline write_proxy get_write_for(std::chrono::duration <Rep, Period> timeout) {
+    return this->get_write_until(clock_type::now() + timeout);
+  }
+
+  /*! \brief Retrieve a read-only proxy to the contained object, waiting at
+   *  most for the timeout given.
+   *
+   * @see get_write_for
+   * \param timeout How long to wait for the lock.
+   *
+   * \return proxy object
+   */
+  template <class Rep, class Period>
+  inline read_proxy get_read_for(std::chrono::duration <Rep, Period> timeout) {
+    return this->get_read_until(clock_type::now() + timeout);
+  }
+
+  /*! \brief Timed variant of \ref get_write_auth.
+   *
+   * \param auth Authorization object to prevent deadlocks.
+   * \param deadline When to give up waiting for the lock.
+   *
+   * \return proxy object
+   */
+  inline write_proxy get_write_auth_until(auth_type &auth, clock_type::time_point deadline) {
+    if (!auth) return write_proxy();
+    return this->get_write_auth_until(auth.get(), deadline);
+  }
+
+  /*! \brief Timed variant of \ref get_read_auth.
+   *
+   * \param auth Authorization object to prevent deadlocks.
+   * \param deadline When to give up waiting for the lock.
+   *
+   * \return proxy object
+   */
+  inline read_proxy get_read_auth_until(auth_type &auth, clock_type::time_point deadline) {
+    if (!auth) return read_proxy();
+    return this->get_read_auth_until(auth.get(), deadline);
+  }
+
+  template <class Rep, class Period>
+  inline write_proxy get_write_auth_for(auth_type &auth, std::chrono::duration <Rep, Period> timeout) {
+    return this->get_write_auth_until(auth, clock_type::now() + timeout);
+  }
+
+  template <class Rep, class Period>
+  inline read_proxy get_read_auth_for(auth_type &auth, std::chrono::duration <Rep, Period> timeout) {
+    return this->get_read_auth_until(auth, clock_type::now() + timeout);
+  }
+
+  /*! \brief Timed variant of \ref get_write_auth (non-owning).
+   *
+   * \param auth Authorization object to prevent deadlocks (not owned).
+   * \param deadline When to give up waiting for the lock.
+   *
+   * \return proxy object
+   */
+  virtual write_proxy get_write_auth_until(lock_auth_base *auth, clock_type::time_point /*deadline*/) {
+    //(containers without timed support make a non-blocking attempt)
+    return this->get_write_auth(auth, false);
+  }
+
+  /*! \brief Timed variant of \ref get_read_auth (non-owning).
+   *
+   * \param auth Authorization object to prevent deadlocks (not owned).
+   * \param deadline When to give up waiting for the lock.
+   *
+   * \return proxy object
+   */
+  virtual read_proxy get_read_auth_until(lock_auth_base *auth, clock_type::time_point /*deadline*/) {
+    //(containers without timed support make a non-blocking attempt)
+    return this->get_read_auth(auth, false);
+  }
+
+  /*! \brief Timed variant of \ref get_write_multi.
+   *
+   * \param meta_lock Multi-lock object to manage multiple locks.
+   * \param auth Authorization object to prevent deadlocks.
+   * \param deadline When to give up waiting for the locks.
+   *
+   * \return proxy object
+   */
+  inline write_proxy get_write_multi_until(meta_lock_base &meta_lock,
+    auth_type &auth, clock_type::time_point deadline) {
+    if (!auth) return write_proxy();
+    return this->get_write_multi_until(meta_lock.get_lock_object(), auth.get(), deadline);
+  }
+
+  /*! \brief Timed variant of \ref get_read_multi.
+   *
+   * \param meta_lock Multi-lock object to manage multiple locks.
+   * \param auth Authorization object to prevent deadlocks.
+   * \param deadline When to give up waiting for the locks.
+   *
+   * \return proxy object
+   */
+  inline read_proxy get_read_multi_until(meta_lock_base &meta_lock,
+    auth_type &auth, clock_type::time_point deadline) {
+    if (!auth) return read_proxy();
+    return this->get_read_multi_until(meta_lock.get_lock_object(), auth.get(), deadline);
+  }
+
+  template <class Rep, class Period>
+  inline write_proxy get_write_multi_for(meta_lock_base &meta_lock, auth_type &auth,
+    std::chrono::duration <Rep, Period> timeout) {
+    return this->get_write_multi_until(meta_lock, auth, clock_type::now() + timeout);
+  }
+
+  template <class Rep, class Period>
+  inline read_proxy get_read_multi_for(meta_lock_base &meta_lock, auth_type &auth,
+    std::chrono::duration <Rep, Period> timeout) {
+    return this->get_read_multi_until(meta_lock, auth, clock_type::now() + timeout);
+  }
+
+  //@}
+
   /*! Get a new authorization object.*/
   virtual auth_type get_new_auth() const {
     return auth_type();
@@ -221,12 +426,19 @@ public:
     return 0;
   }
 
+  /*! \brief Get the container's current write generation.
+   *
+   * @see lock_base::get_generation
+   * \return generation value, or < 0 if the container's lock doesn't track
+   * write generations
+   */
+  virtual count_type get_generation() const {
+    return -1;
+  }
+
   virtual inline ~locking_container_base() {}
 
 protected:
-  virtual write_proxy get_write_auth(lock_auth_base *auth, bool block) = 0;
-  virtual read_proxy  get_read_auth(lock_auth_base *auth, bool block)  = 0;
-
   virtual write_proxy get_write_multi(lock_base* /*meta_lock*/,
     lock_auth_base* /*auth*/, bool /*block*/) {
     return write_proxy();
@@ -236,6 +448,18 @@ protected:
     lock_auth_base* /*auth*/, bool /*block*/) {
     return read_proxy();
   }
+
+  virtual write_proxy get_write_multi_until(lock_base *meta_lock,
+    lock_auth_base *auth, clock_type::time_point /*deadline*/) {
+    //(containers without timed support make a non-blocking attempt)
+    return this->get_write_multi(meta_lock, auth, false);
+  }
+
+  virtual read_proxy get_read_multi_until(lock_base *meta_lock,
+    lock_auth_base *auth, clock_type::time_point /*deadline*/) {
+    //(containers without timed support make a non-blocking attempt)
+    return this->get_read_multi(meta_lock, auth, false);
+  }
 };
 
 
@@ -261,13 +485,21 @@ public:
   using typename base::type;
   using typename base::write_proxy;
   using typename base::read_proxy;
+  using typename base::unique_write_proxy;
+  using typename base::unique_read_proxy;
   using typename base::auth_type;
   using typename base::order_type;
+  using typename base::count_type;
+  using typename base::clock_type;
   //NOTE: this is needed so that the 'lock_auth_base' variants are pulled in
   using base::get_write_auth;
   using base::get_read_auth;
   using base::get_write_multi;
   using base::get_read_multi;
+  using base::get_write_auth_until;
+  using base::get_read_auth_until;
+  using base::get_write_multi_until;
+  using base::get_read_multi_until;
 
   /*! \brief Constructor.
    *
@@ -296,82 +528,639 @@ private:
   locking_container &operator = (const locking_container&);
 
 public:
-  /** @name Authorization
+  /** @name Allocation-free Accessor Functions
    *
    */
   //@{
 
-  /*! Get a new authorization object.*/
-  auth_type get_new_auth() const {
-    return locking_container::new_auth();
+  /*! \brief Retrieve a writable move-only proxy to the contained object.
+   *
+   * Unlike \ref locking_container_base::get_write, this performs no heap
+   * allocation; the lock state is stored inline in the returned proxy.
+   *
+   * @see unique_object_proxy
+   * \param block Should the call block for a lock?
+   *
+   * \return proxy object
+   */
+  inline unique_write_proxy get_write_unique(bool block = true) {
+    return unique_write_proxy(&contained, &locks, NULL, false, block, NULL);
   }
 
-  /*! Get a new authorization object.*/
-  static auth_type new_auth() {
-    return auth_type(new auth_base_type);
+  /*! \brief Retrieve a read-only move-only proxy to the contained object.
+   *
+   * @see get_write_unique
+   * \param block Should the call block for a lock?
+   *
+   * \return proxy object
+   */
+  inline unique_read_proxy get_read_unique(bool block = true) {
+    return unique_read_proxy(&contained, &locks, NULL, true, block, NULL);
   }
 
-  /*! Get the container's order.*/
-  order_type get_order() const {
-    return locks.get_order();
+  /*! \brief Retrieve a writable move-only proxy to the contained object using
+   *  deadlock prevention.
+   *
+   * @see get_write_unique
+   * \param auth Authorization object to prevent deadlocks.
+   * \param block Should the call block for a lock?
+   *
+   * \return proxy object
+   */
+  inline unique_write_proxy get_write_unique_auth(auth_type &auth, bool block = true) {
+    if (!auth) return unique_write_proxy();
+    return unique_write_proxy(&contained, &locks, auth.get(), false, block, NULL);
   }
 
-  //@}
-
-private:
-  inline write_proxy get_write_auth(lock_auth_base *auth, bool block) {
-    return this->get_write_multi(NULL, auth, block);
+  /*! \brief Retrieve a read-only move-only proxy to the contained object using
+   *  deadlock prevention.
+   *
+   * @see get_write_unique
+   * \param auth Authorization object to prevent deadlocks.
+   * \param block Should the call block for a lock?
+   *
+   * \return proxy object
+   */
+  inline unique_read_proxy get_read_unique_auth(auth_type &auth, bool block = true) {
+    if (!auth) return unique_read_proxy();
+    return unique_read_proxy(&contained, &locks, auth.get(), true, block, NULL);
   }
 
-  inline read_proxy get_read_auth(lock_auth_base *auth, bool block) {
-    return this->get_read_multi(NULL, auth, block);
+  /*! \brief Retrieve a writable move-only proxy to the contained object using
+   *  deadlock prevention and multiple locking functionality.
+   *
+   * @see get_write_unique_auth
+   * \param meta_lock Multi-lock object to manage multiple locks.
+   * \param auth Authorization object to prevent deadlocks.
+   * \param block Should the call block for a lock?
+   *
+   * \return proxy object
+   */
+  inline unique_write_proxy get_write_unique_multi(meta_lock_base &meta_lock,
+    auth_type &auth, bool block = true) {
+    if (!auth) return unique_write_proxy();
+    return unique_write_proxy(&contained, &locks, auth.get(), false, block,
+      meta_lock.get_lock_object());
   }
 
-  inline write_proxy get_write_multi(lock_base *meta_lock, lock_auth_base *auth, bool block) {
-    //NOTE: no read/write choice is given here!
-    return write_proxy(&contained, &locks, auth, false, block, meta_lock);
+  /*! \brief Retrieve a read-only move-only proxy to the contained object using
+   *  deadlock prevention and multiple locking functionality.
+   *
+   * @see get_write_unique_auth
+   * \param meta_lock Multi-lock object to manage multiple locks.
+   * \param auth Authorization object to prevent deadlocks.
+   * \param block Should the call block for a lock?
+   *
+   * \return proxy object
+   */
+  inline unique_read_proxy get_read_unique_multi(meta_lock_base &meta_lock,
+    auth_type &auth, bool block = true) {
+    if (!auth) return unique_read_proxy();
+    return unique_read_proxy(&contained, &locks, auth.get(), true, block,
+      meta_lock.get_lock_object());
   }
 
-  inline read_proxy get_read_multi(lock_base *meta_lock, lock_auth_base *auth,
-    bool block) {
-    return read_proxy(&contained, &locks, auth, true, block, meta_lock);
+  //@}
+
+  /** @name Closure-based Accessor Functions
+   *
+   */
+  //@{
+
+  /*! \brief Invoke a callable on the contained object while holding a write
+   *  lock.
+   *
+   * This avoids materializing a proxy object at the call site: the lock is
+   * held for exactly the duration of the call, and the critical section can be
+   * inlined. If the lock can't be obtained the callable isn't invoked and a
+   * value-initialized result is returned; if you need to distinguish that case
+   * from a legitimate result, use \ref get_write_unique instead.
+   *
+   * \param function callable taking a 'type&' argument
+   * \param block Should the call block for a lock?
+   *
+   * \return the callable's result
+   */
+  template <class Func>
+  inline auto with_write(Func function, bool block = true) ->
+    decltype(function(std::declval <type&> ())) {
+    unique_write_proxy write = this->get_write_unique(block);
+    if (!write) return decltype(function(std::declval <type&> ()))();
+    return function(*write);
   }
 
-  type contained;
-  Lock locks;
-};
+  /*! \brief Invoke a callable on the contained object while holding a read
+   *  lock.
+   *
+   * @see with_write
+   * \param function callable taking a 'const type&' argument
+   * \param block Should the call block for a lock?
+   *
+   * \return the callable's result
+   */
+  template <class Func>
+  inline auto with_read(Func function, bool block = true) ->
+    decltype(function(std::declval <const type&> ())) {
+    unique_read_proxy read = this->get_read_unique(block);
+    if (!read) return decltype(function(std::declval <const type&> ()))();
+    return function(*read);
+  }
 
+  /*! \brief Invoke a callable while holding a write lock, using deadlock
+   *  prevention.
+   *
+   * @see with_write
+   * \param auth Authorization object to prevent deadlocks.
+   * \param function callable taking a 'type&' argument
+   * \param block Should the call block for a lock?
+   *
+   * \return the callable's result
+   */
+  template <class Func>
+  inline auto with_write_auth(auth_type &auth, Func function, bool block = true) ->
+    decltype(function(std::declval <type&> ())) {
+    unique_write_proxy write = this->get_write_unique_auth(auth, block);
+    if (!write) return decltype(function(std::declval <type&> ()))();
+    return function(*write);
+  }
 
-/*! Helper function used by \ref get_two_locks.*/
-template <class Type>
-static bool auto_get_lock(locking_container_base <Type> &object, lock_auth_base::auth_type &auth,
-  meta_lock_base *master_lock, typename locking_container_base <Type> ::write_proxy &write,
-  bool block = true) {
-  if (master_lock && auth) {
-    write = object.get_write_multi(*master_lock, auth, block);
-  } else if (auth) {
-    write = object.get_write_auth(auth, block);
-  } else {
-    write = object.get_write(block);
+  /*! \brief Invoke a callable while holding a read lock, using deadlock
+   *  prevention.
+   *
+   * @see with_write
+   * \param auth Authorization object to prevent deadlocks.
+   * \param function callable taking a 'const type&' argument
+   * \param block Should the call block for a lock?
+   *
+   * \return the callable's result
+   */
+  template <class Func>
+  inline auto with_read_auth(auth_type &auth, Func function, bool block = true) ->
+    decltype(function(std::declval <const type&> ())) {
+    unique_read_proxy read = this->get_read_unique_auth(auth, block);
+    if (!read) return decltype(function(std::declval <const type&> ()))();
+    return function(*read);
   }
-  return (bool) write;
-}
 
+  /*! \brief Invoke a callable while holding a write lock, using deadlock
+   *  prevention and multiple locking functionality.
+   *
+   * @see with_write
+   * \param meta_lock Multi-lock object to manage multiple locks.
+   * \param auth Authorization object to prevent deadlocks.
+   * \param function callable taking a 'type&' argument
+   * \param block Should the call block for a lock?
+   *
+   * \return the callable's result
+   */
+  template <class Func>
+  inline auto with_write_multi(meta_lock_base &meta_lock, auth_type &auth,
+    Func function, bool block = true) ->
+    decltype(function(std::declval <type&> ())) {
+    unique_write_proxy write = this->get_write_unique_multi(meta_lock, auth, block);
+    if (!write) return decltype(function(std::declval <type&> ()))();
+    return function(*write);
+  }
 
-/*! Helper function used by \ref get_two_locks.*/
-template <class Type>
-static bool auto_get_lock(locking_container_base <Type> &object, lock_auth_base::auth_type &auth,
-  meta_lock_base *master_lock, typename locking_container_base <Type> ::read_proxy &read,
-  bool block = true) {
-  if (master_lock && auth) {
-    read = object.get_read_multi(*master_lock, auth, block);
-  } else if (auth) {
-    read = object.get_read_auth(auth, block);
-  } else {
-    read = object.get_read(block);
+  /*! \brief Invoke a callable while holding a read lock, using deadlock
+   *  prevention and multiple locking functionality.
+   *
+   * @see with_write
+   * \param meta_lock Multi-lock object to manage multiple locks.
+   * \param auth Authorization object to prevent deadlocks.
+   * \param function callable taking a 'const type&' argument
+   * \param block Should the call block for a lock?
+   *
+   * \return the callable's result
+   */
+  template <class Func>
+  inline auto with_read_multi(meta_lock_base &meta_lock, auth_type &auth,
+    Func function, bool block = true) ->
+    decltype(function(std::declval <const type&> ())) {
+    unique_read_proxy read = this->get_read_unique_multi(meta_lock, auth, block);
+    if (!read) return decltype(function(std::declval <const type&> ()))();
+    return function(*read);
   }
-  return (bool) read;
-}
+
+  //@}
+
+  /** @name Condition Waiting Functions
+   *
+   */
+  //@{
+
+  /*! \brief Obtain a write proxy once a condition on the contained object
+   *  holds.
+   *
+   * This replaces the lock/inspect/release/retry polling idiom with a true
+   * blocking wait: the predicate is evaluated with a const reference to the
+   * contained object under the container's write lock, and while it returns
+   * false the lock is atomically released and the calling thread parks until
+   * some thread releases a write lock on this container (see
+   * \ref lock_base::wait_for_update), then rechecks under the re-acquired
+   * lock. On success the returned proxy holds the write lock with the
+   * predicate satisfied; no other writer can have intervened since the final
+   * check.
+   *
+   * \attention This requires a lock type with update notifications (currently
+   * \ref rw_lock); for other lock types an empty proxy is returned.
+   *
+   * \param predicate callable taking a 'const type&' argument
+   *
+   * \return proxy object
+   */
+  template <class Predicate>
+  write_proxy wait_for_condition(Predicate predicate) {
+    if (locks.lock(NULL, false, true) < 0) return write_proxy();
+    while (!predicate(const_cast <const type&> (contained))) {
+      if (locks.wait_for_update(NULL, false) < 0) {
+        locks.unlock(NULL, false);
+        return write_proxy();
+      }
+    }
+    //(hand the already-held lock to the proxy; see the timed accessors)
+    return write_proxy(&contained, &locks, NULL, false, NULL);
+  }
+
+  /*! \brief Obtain a write proxy once a condition holds, using deadlock
+   *  prevention.
+   *
+   * @see wait_for_condition
+   * \param predicate callable taking a 'const type&' argument
+   * \param auth Authorization object to prevent deadlocks.
+   *
+   * \return proxy object
+   */
+  template <class Predicate>
+  write_proxy wait_for_condition_auth(Predicate predicate, auth_type &auth) {
+    if (!auth) return write_proxy();
+    if (locks.lock(auth.get(), false, true) < 0) return write_proxy();
+    while (!predicate(const_cast <const type&> (contained))) {
+      if (locks.wait_for_update(auth.get(), false) < 0) {
+        locks.unlock(auth.get(), false);
+        return write_proxy();
+      }
+    }
+    return write_proxy(&contained, &locks, auth.get(), false, NULL);
+  }
+
+  //@}
+
+  /** @name Optimistic Read Functions
+   *
+   */
+  //@{
+
+  /*! \brief Obtain an unlocked, generation-stamped view of the contained
+   *  object.
+   *
+   * Unlike \ref locking_container_base::get_read, this takes no lock at all:
+   * writers are never blocked, no matter how long the caller computes over
+   * the view, and \ref stale_read::revalidate afterward reveals whether any
+   * write intervened (in which case the caller retries).
+   *
+   * @see stale_read
+   * \attention If a writer is mid-update when the view is requested, or the
+   * container's lock doesn't track write generations, an empty view is
+   * returned; check it like any proxy.
+   *
+   * \return unlocked view of the contained object
+   */
+  inline stale_read <type> get_stale_read() const {
+    static_assert(std::is_trivially_copyable <type> ::value,
+      "stale_read requires a trivially-copyable type");
+    return stale_read <type> (&contained, &locks);
+  }
+
+  //@}
+
+  /** @name Authorization
+   *
+   */
+  //@{
+
+  /*! Get a new authorization object.*/
+  auth_type get_new_auth() const {
+    return locking_container::new_auth();
+  }
+
+  /*! Get a new authorization object.*/
+  static auth_type new_auth() {
+    return auth_type(new auth_base_type);
+  }
+
+  /*! Get the container's order.*/
+  order_type get_order() const {
+    return locks.get_order();
+  }
+
+  /*! Get the container's current write generation.*/
+  count_type get_generation() const {
+    return locks.get_generation();
+  }
+
+  //@}
+
+  //(the non-owning fast-path overloads; see locking_container_base)
+  inline write_proxy get_write_auth(lock_auth_base *auth, bool block) {
+    return this->get_write_multi(NULL, auth, block);
+  }
+
+  inline read_proxy get_read_auth(lock_auth_base *auth, bool block) {
+    return this->get_read_multi(NULL, auth, block);
+  }
+
+  //(the timed variants; see locking_container_base)
+  inline write_proxy get_write_auth_until(lock_auth_base *auth, typename clock_type::time_point deadline) {
+    return this->get_write_multi_until(NULL, auth, deadline);
+  }
+
+  inline read_proxy get_read_auth_until(lock_auth_base *auth, typename clock_type::time_point deadline) {
+    return this->get_read_multi_until(NULL, auth, deadline);
+  }
+
+protected:
+  //NOTE: these are protected (not private) so that subclasses such as
+  //static_locking_container can call them with static dispatch
+  inline write_proxy get_write_multi(lock_base *meta_lock, lock_auth_base *auth, bool block) {
+    //NOTE: no read/write choice is given here!
+    return write_proxy(&contained, &locks, auth, false, block, meta_lock);
+  }
+
+  inline read_proxy get_read_multi(lock_base *meta_lock, lock_auth_base *auth,
+    bool block) {
+    return read_proxy(&contained, &locks, auth, true, block, meta_lock);
+  }
+
+  //(these mirror the locking done by object_proxy's internal lock state, but
+  //with deadline-aware locking; the proxy then adopts the locks already held)
+  write_proxy get_write_multi_until(lock_base *meta_lock, lock_auth_base *auth,
+    typename clock_type::time_point deadline) {
+    if (meta_lock && meta_lock->lock_until(auth, true, deadline, true) < 0) {
+      return write_proxy();
+    }
+    if (locks.lock_until(auth, false, deadline) < 0) {
+      if (meta_lock) meta_lock->unlock(auth, true, true);
+      return write_proxy();
+    }
+    return write_proxy(&contained, &locks, auth, false, meta_lock);
+  }
+
+  read_proxy get_read_multi_until(lock_base *meta_lock, lock_auth_base *auth,
+    typename clock_type::time_point deadline) {
+    if (meta_lock && meta_lock->lock_until(auth, true, deadline, true) < 0) {
+      return read_proxy();
+    }
+    if (locks.lock_until(auth, true, deadline) < 0) {
+      if (meta_lock) meta_lock->unlock(auth, true, true);
+      return read_proxy();
+    }
+    return read_proxy(&contained, &locks, auth, true, meta_lock);
+  }
+
+  //(wrap a lock already obtained on 'locks' in a proxy; for subclasses whose
+  //accessors acquire the lock through their own mechanisms, e.g.,
+  //async_locking_container)
+  inline write_proxy adopt_write_lock(lock_auth_base *auth) {
+    return write_proxy(&contained, &locks, auth, false, NULL);
+  }
+
+  inline read_proxy adopt_read_lock(lock_auth_base *auth) {
+    return read_proxy(&contained, &locks, auth, true, NULL);
+  }
+
+protected:
+  //NOTE: these are protected (not private) so that subclasses such as
+  //seqlock_container can access the object and lock together
+  type contained;
+  Lock locks;
+};
+
+
+/*! \class static_locking_container
+ *  \brief \ref locking_container variant with compile-time accessor dispatch.
+ *
+ * This container is identical to \ref locking_container, except that its
+ * accessor functions are non-virtual: when the call site knows this concrete
+ * type, the entire lock path (down to the lock's own 'lock'/'unlock') resolves
+ * at compile time and can be fully inlined. The container can still be passed
+ * around as a \ref locking_container_base for heterogeneous collections, in
+ * which case access through the base reverts to virtual dispatch.
+ */
+
+template <class Type, class Lock = rw_lock>
+class static_locking_container : public locking_container <Type, Lock> {
+public:
+  typedef locking_container <Type, Lock> base;
+  using typename base::type;
+  using typename base::write_proxy;
+  using typename base::read_proxy;
+  using typename base::unique_write_proxy;
+  using typename base::unique_read_proxy;
+  using typename base::auth_type;
+  using typename base::order_type;
+  //NOTE: this is needed so that the 'lock_auth_base' variants aren't hidden by
+  //the non-virtual accessors below
+  using base::get_write_auth;
+  using base::get_read_auth;
+  using base::get_write_multi;
+  using base::get_read_multi;
+
+  /*! \brief Constructor.*/
+  explicit static_locking_container() {}
+
+  /*! \brief Constructor.
+   *
+   * \param object object to move as contained object.
+   * \param args arguments to pass to the lock's constructor.
+   */
+  template <class ... Types>
+  explicit static_locking_container(type &&object, Types ... args) :
+    base(std::move(object), args...) {}
+
+  /*! \brief Constructor.
+   *
+   * \param object object to copy as contained object.
+   * \param args arguments to pass to the lock's constructor.
+   */
+  template <class ... Types>
+  explicit static_locking_container(const type &object, Types ... args) :
+    base(object, args...) {}
+
+  /** @name Accessor Functions (non-virtual)
+   *
+   */
+  //@{
+
+  /*! \brief Retrieve a writable proxy to the contained object.
+   *
+   * @see locking_container_base::get_write
+   */
+  inline write_proxy get_write(bool block = true) {
+    return this->base::get_write_multi(NULL, NULL, block);
+  }
+
+  /*! \brief Retrieve a read-only proxy to the contained object.
+   *
+   * @see locking_container_base::get_read
+   */
+  inline read_proxy get_read(bool block = true) {
+    return this->base::get_read_multi(NULL, NULL, block);
+  }
+
+  /*! \brief Retrieve a writable proxy to the contained object using deadlock
+   *  prevention.
+   *
+   * @see locking_container_base::get_write_auth
+   */
+  inline write_proxy get_write_auth(auth_type &auth, bool block = true) {
+    if (!auth) return write_proxy();
+    return this->base::get_write_multi(NULL, auth.get(), block);
+  }
+
+  /*! \brief Retrieve a read-only proxy to the contained object using deadlock
+   *  prevention.
+   *
+   * @see locking_container_base::get_read_auth
+   */
+  inline read_proxy get_read_auth(auth_type &auth, bool block = true) {
+    if (!auth) return read_proxy();
+    return this->base::get_read_multi(NULL, auth.get(), block);
+  }
+
+  /*! \brief Retrieve a writable proxy to the contained object using deadlock
+   *  prevention and multiple locking functionality.
+   *
+   * @see locking_container_base::get_write_multi
+   */
+  inline write_proxy get_write_multi(meta_lock_base &meta_lock, auth_type &auth,
+    bool block = true) {
+    if (!auth) return write_proxy();
+    return this->base::get_write_multi(meta_lock.get_lock_object(), auth.get(), block);
+  }
+
+  /*! \brief Retrieve a read-only proxy to the contained object using deadlock
+   *  prevention and multiple locking functionality.
+   *
+   * @see locking_container_base::get_read_multi
+   */
+  inline read_proxy get_read_multi(meta_lock_base &meta_lock, auth_type &auth,
+    bool block = true) {
+    if (!auth) return read_proxy();
+    return this->base::get_read_multi(meta_lock.get_lock_object(), auth.get(), block);
+  }
+
+  //@}
+
+private:
+  static_locking_container(const static_locking_container&);
+  static_locking_container &operator = (const static_locking_container&);
+};
+
+
+/*! \class seqlock_container
+ *  \brief Container for small trivially-copyable objects with optimistic,
+ *  lock-free reads.
+ *
+ * This container protects the object with a \ref seq_lock: writers use the
+ * usual proxy machinery (\ref locking_container_base::get_write, etc.), while
+ * readers call \ref seqlock_container::read_copy to obtain a validated
+ * by-value snapshot without writing any shared state. Because readers
+ * validate after copying, the contained type must be trivially copyable; a
+ * pointer proxy can't be handed out for reading, so
+ * \ref locking_container_base::get_read always fails for this container.
+ */
+
+template <class Type>
+class seqlock_container : public locking_container <Type, seq_lock> {
+  static_assert(std::is_trivially_copyable <Type> ::value,
+    "seqlock_container requires a trivially-copyable type");
+
+public:
+  typedef locking_container <Type, seq_lock> base;
+  using typename base::type;
+  using typename base::write_proxy;
+  using typename base::auth_type;
+
+  /*! \brief Constructor.*/
+  explicit seqlock_container() {}
+
+  /*! \brief Constructor.
+   *
+   * \param object object to copy as contained object.
+   */
+  explicit seqlock_container(const type &object) : base(object) {}
+
+  /*! \brief Obtain a validated snapshot of the contained object.
+   *
+   * This copies the object without taking a lock, retrying until no write
+   * overlapped the copy. It never blocks writers and never fails, but it can
+   * retry indefinitely if writes are continuous.
+   *
+   * \return snapshot of the contained object
+   */
+  type read_copy() const {
+    type copy;
+    seq_lock::count_type current = 0;
+    do {
+      current = this->locks.read_begin();
+      //NOTE: a plain assignment would race with writers; the copy is only
+      //used once 'read_retry' confirms that no write overlapped it
+      memcpy(&copy, &this->contained, sizeof(type));
+    } while (this->locks.read_retry(current));
+    return copy;
+  }
+
+private:
+  seqlock_container(const seqlock_container&);
+  seqlock_container &operator = (const seqlock_container&);
+};
+
+
+/*! \brief Container with cache-line padding between the object and the lock.
+ *
+ * This is a \ref locking_container whose lock is wrapped in \ref padded_lock:
+ * the lock's state starts on its own cache line rather than sharing one with
+ * the tail of the contained object, and the container as a whole is padded out
+ * to full cache lines so that adjacent containers (e.g., elements of an array
+ * of containers) don't false-share. See \ref padded_lock for the allocation
+ * caveat that comes with the over-alignment.
+ */
+
+template <class Type, class Lock = rw_lock>
+using padded_locking_container = locking_container <Type, padded_lock <Lock> >;
+
+
+/*! Helper function used by \ref get_two_locks.*/
+template <class Type>
+static bool auto_get_lock(locking_container_base <Type> &object, lock_auth_base::auth_type &auth,
+  meta_lock_base *master_lock, typename locking_container_base <Type> ::write_proxy &write,
+  bool block = true) {
+  if (master_lock && auth) {
+    write = object.get_write_multi(*master_lock, auth, block);
+  } else if (auth) {
+    write = object.get_write_auth(auth, block);
+  } else {
+    write = object.get_write(block);
+  }
+  return (bool) write;
+}
+
+
+/*! Helper function used by \ref get_two_locks.*/
+template <class Type>
+static bool auto_get_lock(locking_container_base <Type> &object, lock_auth_base::auth_type &auth,
+  meta_lock_base *master_lock, typename locking_container_base <Type> ::read_proxy &read,
+  bool block = true) {
+  if (master_lock && auth) {
+    read = object.get_read_multi(*master_lock, auth, block);
+  } else if (auth) {
+    read = object.get_read_auth(auth, block);
+  } else {
+    read = object.get_read(block);
+  }
+  return (bool) read;
+}
 
 
 /*! \brief Attempt to lock two containers.
@@ -403,16 +1192,247 @@ bool get_two_locks(locking_container_base <Type1> &object1,
   proxy2.clear();
   bool order = object1.get_order() <= object2.get_order();
   if (order) {
-    if (!auto_get_lock(object1, auth, master_lock, proxy1)) return false;
-    if (!auto_get_lock(object2, auth, master_lock, proxy2)) proxy1.clear();
+    if (!auto_get_lock(object1, auth, master_lock, proxy1, block)) return false;
+    if (!auto_get_lock(object2, auth, master_lock, proxy2, block)) proxy1.clear();
+  } else {
+    if (!auto_get_lock(object2, auth, master_lock, proxy2, block)) return false;
+    if (!auto_get_lock(object1, auth, master_lock, proxy1, block)) proxy2.clear();
+  }
+  return proxy1 && proxy2;
+}
+
+
+//(the compile-time order of a container is that of its lock)
+template <class Type, class Lock>
+struct static_lock_order <locking_container <Type, Lock> > : static_lock_order <Lock> {};
+
+
+/*! \brief Lock two containers with compile-time-checked lock orders.
+ *
+ * This overload is selected when both containers use \ref static_ordered_lock
+ * (possibly behind wrappers). The acquisition order is resolved at compile
+ * time from the two lock orders, and equal orders are rejected with a
+ * static_assert instead of at runtime.
+ */
+template <class Type1, class Lock1, class Type2, class Lock2, class Proxy1, class Proxy2>
+typename std::enable_if <(static_lock_order <Lock1> ::value > 0) &&
+                         (static_lock_order <Lock2> ::value > 0), bool> ::type
+get_two_locks(locking_container <Type1, Lock1> &object1,
+              locking_container <Type2, Lock2> &object2,
+  Proxy1 &proxy1, Proxy2 &proxy2, bool block = true,
+  lock_auth_base::auth_type auth = lock_auth_base::auth_type(),
+  meta_lock_base *master_lock = NULL) {
+  static_assert(static_lock_order <Lock1> ::value != static_lock_order <Lock2> ::value,
+    "containers with equal static lock orders can't be locked together");
+  proxy1.clear();
+  proxy2.clear();
+  //(resolved at compile time)
+  if (static_lock_order <Lock1> ::value < static_lock_order <Lock2> ::value) {
+    if (!auto_get_lock(object1, auth, master_lock, proxy1, block)) return false;
+    if (!auto_get_lock(object2, auth, master_lock, proxy2, block)) proxy1.clear();
   } else {
-    if (!auto_get_lock(object2, auth, master_lock, proxy2)) return false;
-    if (!auto_get_lock(object1, auth, master_lock, proxy1)) proxy2.clear();
+    if (!auto_get_lock(object2, auth, master_lock, proxy2, block)) return false;
+    if (!auto_get_lock(object1, auth, master_lock, proxy1, block)) proxy2.clear();
   }
   return proxy1 && proxy2;
 }
 
 
+/*! Type-erased (container, proxy) pair used by \ref get_all_locks.*/
+class multi_lock_item {
+public:
+  virtual lock_base::order_type get_order() const = 0;
+  virtual bool acquire(lock_auth_base::auth_type &auth, meta_lock_base *master_lock, bool block) = 0;
+  virtual void release() = 0;
+  virtual inline ~multi_lock_item() {}
+};
+
+
+/*! Helper class used by \ref get_all_locks.*/
+template <class Type, class Proxy>
+class bound_lock_item : public multi_lock_item {
+public:
+  bound_lock_item(locking_container_base <Type> &new_object, Proxy &new_proxy) :
+    object(new_object), proxy(new_proxy) {}
+
+  lock_base::order_type get_order() const {
+    return object.get_order();
+  }
+
+  bool acquire(lock_auth_base::auth_type &auth, meta_lock_base *master_lock, bool block) {
+    return auto_get_lock(object, auth, master_lock, proxy, block);
+  }
+
+  void release() {
+    proxy.clear();
+  }
+
+private:
+  locking_container_base <Type> &object;
+  Proxy                         &proxy;
+};
+
+
+/*! Helper functions used by \ref get_all_locks.*/
+inline void collect_lock_items(std::vector <std::unique_ptr <multi_lock_item>>&) {}
+
+template <class Type, class Proxy, class ... Rest>
+void collect_lock_items(std::vector <std::unique_ptr <multi_lock_item>> &items,
+  locking_container_base <Type> &object, Proxy &proxy, Rest &... rest) {
+  items.emplace_back(new bound_lock_item <Type, Proxy> (object, proxy));
+  collect_lock_items(items, rest...);
+}
+
+
+/*! Helper class used by \ref get_all_locks to validate static lock orders.*/
+template <lock_base::order_type Previous, class ... Rest>
+struct static_order_check;
+
+template <lock_base::order_type Previous>
+struct static_order_check <Previous> {
+  static const bool all_ordered = true;
+  static const bool ascending   = true;
+};
+
+template <lock_base::order_type Previous, class Container, class Proxy, class ... Rest>
+struct static_order_check <Previous, Container, Proxy, Rest...> {
+private:
+  static const lock_base::order_type order = static_lock_order <Container> ::value;
+  typedef static_order_check <order, Rest...> next;
+
+public:
+  static const bool all_ordered = order > 0 && next::all_ordered;
+  static const bool ascending   = order > Previous && next::ascending;
+};
+
+
+/*! Helper functions used by \ref get_all_locks.*/
+inline void clear_all_proxies() {}
+
+template <class Container, class Proxy, class ... Rest>
+void clear_all_proxies(Container&, Proxy &proxy, Rest &... rest) {
+  proxy.clear();
+  clear_all_proxies(rest...);
+}
+
+inline bool get_all_locks_ordered(bool /*block*/, lock_auth_base::auth_type&,
+  meta_lock_base*) {
+  return true;
+}
+
+template <class Type, class Proxy, class ... Rest>
+bool get_all_locks_ordered(bool block, lock_auth_base::auth_type &auth,
+  meta_lock_base *master_lock, locking_container_base <Type> &object, Proxy &proxy,
+  Rest &... rest) {
+  if (!auto_get_lock(object, auth, master_lock, proxy, block)) return false;
+  if (get_all_locks_ordered(block, auth, master_lock, rest...)) return true;
+  proxy.clear();
+  return false;
+}
+
+
+/*! \brief Attempt to lock any number of containers.
+ *
+ * This generalizes \ref get_two_locks to any number of containers, passed as
+ * alternating container/proxy arguments (the proxy following each container
+ * receives its lock, and its type selects a read or a write lock). Containers
+ * are locked in ascending \ref locking_container_base::get_order order. If all
+ * of the containers have distinct non-zero orders (e.g., they use
+ * \ref ordered_lock), in-order acquisition is deadlock-free by itself and a
+ * multi-lock is never needed. Otherwise, acquisition blocks for at most one
+ * lock at a time while holding no others: on a conflict, everything already
+ * obtained is released, the call waits for the contended container, and then
+ * it retries the whole set. If every container uses \ref static_ordered_lock,
+ * the ascending-order requirement is instead validated with a static_assert
+ * and the runtime sorting and type-erasure are skipped entirely.
+ * \attention All proxies will be cleared before attempting any lock.
+ * \attention If the return is true, all proxies will be non-NULL; otherwise
+ * all will be NULL.
+ * \attention This will not attempt to obtain a multi-lock. If one is necessary,
+ * you must therefore obtain it before calling this function.
+ *
+ * \param block whether or not to block when locking the containers
+ * \param auth authorization object
+ * \param master_lock multi-lock tracking object
+ * \param rest alternating container/proxy arguments
+ * \return success or failure, based entirely on locking success
+ */
+template <class ... Rest>
+bool get_all_locks(bool block, lock_auth_base::auth_type auth,
+  meta_lock_base *master_lock, Rest &... rest) {
+  static_assert(sizeof...(Rest) % 2 == 0,
+    "get_all_locks takes alternating container/proxy arguments");
+  typedef static_order_check <0, Rest...> static_check;
+  static_assert(!static_check::all_ordered || static_check::ascending,
+    "containers with static lock orders must be passed in ascending order");
+  return get_all_locks_internal(
+    std::integral_constant <bool, static_check::all_ordered> (),
+    block, auth, master_lock, rest...);
+}
+
+//(compile-time-checked path: every container uses 'static_ordered_lock' and
+//the static_assert above has already validated ascending order, so in-order
+//blocking acquisition can't deadlock and no sorting is needed)
+template <class ... Rest>
+bool get_all_locks_internal(std::true_type, bool block, lock_auth_base::auth_type auth,
+  meta_lock_base *master_lock, Rest &... rest) {
+  clear_all_proxies(rest...);
+  return get_all_locks_ordered(block, auth, master_lock, rest...);
+}
+
+template <class ... Rest>
+bool get_all_locks_internal(std::false_type, bool block, lock_auth_base::auth_type auth,
+  meta_lock_base *master_lock, Rest &... rest) {
+  std::vector <std::unique_ptr <multi_lock_item>> items;
+  items.reserve(sizeof...(Rest) / 2);
+  collect_lock_items(items, rest...);
+  for (std::size_t i = 0; i < items.size(); i++) {
+    items[i]->release();
+  }
+  if (items.empty()) return true;
+  //sort by lock order; stable, so that unordered (0) items keep call order
+  std::stable_sort(items.begin(), items.end(),
+    [](const std::unique_ptr <multi_lock_item> &left,
+       const std::unique_ptr <multi_lock_item> &right) {
+      return left->get_order() < right->get_order();
+    });
+  //with strictly-ascending non-zero orders, blocking in order can't deadlock
+  bool strictly_ordered = items[0]->get_order() > 0;
+  for (std::size_t i = 1; strictly_ordered && i < items.size(); i++) {
+    strictly_ordered = items[i - 1]->get_order() < items[i]->get_order();
+  }
+  if (strictly_ordered) {
+    for (std::size_t i = 0; i < items.size(); i++) {
+      if (!items[i]->acquire(auth, master_lock, block)) {
+        for (std::size_t j = 0; j < i; j++) items[j]->release();
+        return false;
+      }
+    }
+    return true;
+  }
+  //otherwise, only ever block while holding no other locks: wait for the most
+  //recently contended container, then try-lock the rest, backing off (i.e.,
+  //releasing everything) and re-waiting whenever a conflict shows up
+  std::size_t contended = 0;
+  while (true) {
+    if (!items[contended]->acquire(auth, master_lock, block)) return false;
+    bool success = true;
+    for (std::size_t i = 0; success && i < items.size(); i++) {
+      if (i == contended) continue;
+      if (!items[i]->acquire(auth, master_lock, false)) {
+        success = false;
+        for (std::size_t j = 0; j <= i; j++) items[j]->release();
+        items[contended]->release();
+        if (!block) return false;
+        contended = i;
+      }
+    }
+    if (success) return true;
+    std::this_thread::yield();
+  }
+}
+
+
 /*! \brief Attempt to copy one container's contents into another.
  *
  * @note This will attempt to obtain locks for both containers, and will fail if
@@ -494,6 +1514,179 @@ inline bool try_copy_container(locking_container_base <Type1> &left,
   return true;
 }
 
+
+/*! \brief Attempt to move one container's contents into another.
+ *
+ * This is the move counterpart of \ref try_copy_container: the contents of
+ * right are move-assigned into left, which for types such as std::vector is an
+ * O(1) pointer exchange rather than a deep copy. Both containers are
+ * write-locked, since the source is left in a moved-from state.
+ *
+ * @note This will attempt to obtain locks for both containers, and will fail if
+ * either lock operation fails.
+ *
+ * \param left container being assigned to
+ * \param right container being moved from
+ * \param block whether or not to block when locking the containers
+ * \return success or failure, based entirely on locking success
+ */
+template <class Type1, class Type2>
+inline bool try_move_container(locking_container_base <Type1> &left,
+  locking_container_base <Type2> &right, bool block = true) {
+  typename locking_container_base <Type1> ::write_proxy write;
+  typename locking_container_base <Type2> ::write_proxy write_src;
+
+  if (!get_two_locks(left, right, write, write_src, block)) return false;
+
+  *write = std::move(*write_src);
+  return true;
+}
+
+
+/*! \brief Attempt to move one container's contents into another.
+ *
+ * @note This will attempt to obtain locks for both containers, and will fail if
+ * either lock operation fails.
+ *
+ * \param left container being assigned to
+ * \param right container being moved from
+ * \param auth authorization object
+ * \param block whether or not to block when locking the containers
+ * \return success or failure, based entirely on locking success
+ */
+template <class Type1, class Type2>
+inline bool try_move_container(locking_container_base <Type1> &left,
+  locking_container_base <Type2> &right, lock_auth_base::auth_type &auth,
+  bool block = true) {
+  typename locking_container_base <Type1> ::write_proxy write;
+  typename locking_container_base <Type2> ::write_proxy write_src;
+
+  if (!get_two_locks(left, right, write, write_src, block, auth)) return false;
+
+  *write = std::move(*write_src);
+  return true;
+}
+
+/*! \brief Attempt to move one container's contents into another.
+ *
+ * @note This will attempt to obtain locks for both containers using the
+ * \ref meta_lock_base object, and will fail if either lock operation
+ * fails.
+ * \attention This will only work if no other thread holds a lock on either of
+ * the containers.
+ * \attention If try_multi is false, this will fail if the caller doesn't have a
+ * write lock on the \ref meta_lock_base passed.
+ *
+ * \param left container being assigned to
+ * \param right container being moved from
+ * \param meta_lock multi-lock tracking object
+ * \param auth authorization object
+ * \param block whether or not to block when locking the containers
+ * \param try_multi whether or not to attempt a write lock on meta_lock
+ * \return success or failure, based entirely on locking success
+ */
+template <class Type1, class Type2>
+inline bool try_move_container(locking_container_base <Type1> &left,
+  locking_container_base <Type2> &right, meta_lock_base &master_lock,
+  lock_auth_base::auth_type &auth, bool block = true, bool try_multi = true) {
+  meta_lock::write_proxy multi;
+  if (try_multi && !(multi = master_lock.get_write_auth(auth, block))) return false;
+
+  typename locking_container_base <Type1> ::write_proxy write;
+  typename locking_container_base <Type2> ::write_proxy write_src;
+
+  if (!get_two_locks(left, right, write, write_src, block, auth, &master_lock)) return false;
+
+  *write = std::move(*write_src);
+  return true;
+}
+
+
+/*! \brief Attempt to swap two containers' contents.
+ *
+ * This exchanges the two contained objects via unqualified swap (so a
+ * type-specific overload found by ADL is used when one exists, e.g.,
+ * std::vector's O(1) swap). Both containers are write-locked.
+ *
+ * @note This will attempt to obtain locks for both containers, and will fail if
+ * either lock operation fails.
+ *
+ * \param left first container to swap
+ * \param right second container to swap
+ * \param block whether or not to block when locking the containers
+ * \return success or failure, based entirely on locking success
+ */
+template <class Type>
+inline bool try_swap_containers(locking_container_base <Type> &left,
+  locking_container_base <Type> &right, bool block = true) {
+  typename locking_container_base <Type> ::write_proxy write1, write2;
+
+  if (!get_two_locks(left, right, write1, write2, block)) return false;
+
+  using std::swap;
+  swap(*write1, *write2);
+  return true;
+}
+
+
+/*! \brief Attempt to swap two containers' contents.
+ *
+ * @note This will attempt to obtain locks for both containers, and will fail if
+ * either lock operation fails.
+ *
+ * \param left first container to swap
+ * \param right second container to swap
+ * \param auth authorization object
+ * \param block whether or not to block when locking the containers
+ * \return success or failure, based entirely on locking success
+ */
+template <class Type>
+inline bool try_swap_containers(locking_container_base <Type> &left,
+  locking_container_base <Type> &right, lock_auth_base::auth_type &auth,
+  bool block = true) {
+  typename locking_container_base <Type> ::write_proxy write1, write2;
+
+  if (!get_two_locks(left, right, write1, write2, block, auth)) return false;
+
+  using std::swap;
+  swap(*write1, *write2);
+  return true;
+}
+
+/*! \brief Attempt to swap two containers' contents.
+ *
+ * @note This will attempt to obtain locks for both containers using the
+ * \ref meta_lock_base object, and will fail if either lock operation
+ * fails.
+ * \attention This will only work if no other thread holds a lock on either of
+ * the containers.
+ * \attention If try_multi is false, this will fail if the caller doesn't have a
+ * write lock on the \ref meta_lock_base passed.
+ *
+ * \param left first container to swap
+ * \param right second container to swap
+ * \param meta_lock multi-lock tracking object
+ * \param auth authorization object
+ * \param block whether or not to block when locking the containers
+ * \param try_multi whether or not to attempt a write lock on meta_lock
+ * \return success or failure, based entirely on locking success
+ */
+template <class Type>
+inline bool try_swap_containers(locking_container_base <Type> &left,
+  locking_container_base <Type> &right, meta_lock_base &master_lock,
+  lock_auth_base::auth_type &auth, bool block = true, bool try_multi = true) {
+  meta_lock::write_proxy multi;
+  if (try_multi && !(multi = master_lock.get_write_auth(auth, block))) return false;
+
+  typename locking_container_base <Type> ::write_proxy write1, write2;
+
+  if (!get_two_locks(left, right, write1, write2, block, auth, &master_lock)) return false;
+
+  using std::swap;
+  swap(*write1, *write2);
+  return true;
+}
+
 } //namespace lc
 
 #endif //lc_locking_container_hpp
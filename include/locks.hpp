@@ -37,9 +37,15 @@
 #define lc_locks_hpp
 
 #include <atomic>
+#include <chrono>
+#include <cstddef>
 #include <condition_variable>
 #include <memory>
 #include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
 
 #include <assert.h>
 
@@ -48,6 +54,10 @@
 namespace lc {
 
 
+/*! Assumed size of one cache line, for false-sharing control.*/
+const std::size_t cache_line_size = 64;
+
+
 /*! \class lock_base
  *  \brief Base class for lock classes.
  */
@@ -63,6 +73,54 @@ public:
   /*! Return < 0 must mean failure. Should return the current number of read locks on success.*/
   virtual count_type unlock(lock_auth_base *auth, bool read, bool test = false) = 0;
 
+  /*! \brief Release 'count' locks held the same way in one call.
+   *
+   * Semantically identical to calling \ref unlock 'count' times with the same
+   * arguments, which is the default; locks that can release several
+   * references under one mutex acquisition override this (see \ref
+   * proxy_group). Return < 0 must mean failure.
+   */
+  virtual count_type unlock_batch(lock_auth_base *auth, bool read, count_type count,
+    bool test = false);
+
+  /*! \brief Convert a read lock held by the caller into a write lock without
+   *  releasing it.
+   *
+   * Return < 0 must mean failure, in which case the read lock remains held.
+   * Locks that don't support upgrading fail unconditionally, which is the
+   * default.
+   */
+  virtual count_type upgrade(lock_auth_base *auth, bool block = true);
+
+  /*! \brief Timed variant of \ref lock.
+   *
+   * Wait for the lock until no later than 'deadline', then give up. Return
+   * < 0 must mean failure or timeout. Locks without timed support fall back
+   * to a non-blocking attempt, which is the default.
+   */
+  virtual count_type lock_until(lock_auth_base *auth, bool read,
+    std::chrono::steady_clock::time_point deadline, bool test = false);
+
+  /*! \brief Atomically release a held lock and wait for the next write unlock.
+   *
+   * The caller must hold the lock (of the kind indicated by 'read'). The lock
+   * is released, the calling thread parks until some thread releases a write
+   * lock, and the lock is then reacquired before returning; the caller's auth.
+   * registration is kept for the duration. Return < 0 must mean the wait isn't
+   * possible, in which case the lock remains held. Locks without update
+   * notifications fail unconditionally, which is the default.
+   */
+  virtual count_type wait_for_update(lock_auth_base *auth, bool read);
+
+  /*! \brief Current write generation of the lock.
+   *
+   * The generation is odd while a writer is active and is incremented again
+   * when the write ends, so an even sample that's unchanged across an
+   * interval proves no write overlapped it (see \ref stale_read). Locks
+   * without generation tracking return < 0, which is the default.
+   */
+  virtual count_type get_generation() const;
+
   virtual order_type get_order() const;
 
 protected:
@@ -74,6 +132,17 @@ protected:
   static inline void release_auth(lock_auth_base *auth, unlock_data &l) {
     if (auth) auth->release_auth(l);
   }
+
+  //(one round of exponential backoff for locks that spin before parking)
+  static inline void spin_pause(unsigned int round) {
+    //NOTE: the relaxed loads keep the loop from being elided without
+    //generating any bus traffic of their own
+    static std::atomic <unsigned int> dummy(0);
+    const unsigned int limit = 1u << (round < 10? round : 10);
+    for (unsigned int i = 0; i < limit; i++) {
+      dummy.load(std::memory_order_relaxed);
+    }
+  }
 };
 
 
@@ -94,7 +163,14 @@ class rw_lock : public lock_base {
 public:
   using lock_base::count_type;
 
-  rw_lock();
+  /*! \param new_spin_limit Number of bounded exponential-backoff spin rounds
+   *  a contending thread makes on the lock state before parking on a
+   *  condition variable. The default of 0 parks immediately, which is the
+   *  right choice when critical sections can be long or cores are scarce;
+   *  deployments with very short critical sections (tens of nanoseconds)
+   *  should use a small number of rounds (e.g., 8) to avoid paying a full
+   *  sleep/wake for contention windows far shorter than a futex round-trip.*/
+  explicit rw_lock(unsigned int new_spin_limit = 0);
 
 private:
   rw_lock(const rw_lock&);
@@ -103,12 +179,347 @@ private:
 public:
   count_type lock(lock_auth_base *auth, bool read, bool block = true, bool test = false);
   count_type unlock(lock_auth_base *auth, bool read, bool test = false);
+  count_type lock_until(lock_auth_base *auth, bool read,
+    std::chrono::steady_clock::time_point deadline, bool test = false);
+
+  /*! \brief Atomically promote a read lock held by the caller to a write lock.
+   *
+   * At most one thread can have an upgrade pending; a second upgrade request
+   * fails immediately rather than deadlocking against the first. On success no
+   * other writer can have modified the object since the caller's read lock was
+   * obtained.
+   */
+  count_type upgrade(lock_auth_base *auth, bool block = true);
+
+  count_type wait_for_update(lock_auth_base *auth, bool read);
+
+  /*! \brief Release several read locks under one mutex acquisition.
+   *
+   * @see lock_base::unlock_batch
+   */
+  count_type unlock_batch(lock_auth_base *auth, bool read, count_type count,
+    bool test = false);
+
+  /*! \brief Current write generation (see \ref lock_base::get_generation).
+   *
+   * This reads the counter without taking the lock's mutex, so it's cheap
+   * enough to sample around an unlocked computation.
+   */
+  count_type get_generation() const;
 
   ~rw_lock();
 
 private:
-  count_type               readers, readers_waiting;
-  bool                     writer, writer_waiting;
+  count_type lock_internal(lock_auth_base *auth, bool read, bool block, bool test,
+    const std::chrono::steady_clock::time_point *deadline);
+  void restore_read_auth(lock_auth_base *auth);
+
+  const unsigned int       spin_limit;
+  count_type               readers, readers_waiting, update_waiting;
+  //(incremented when a write begins and again when it ends, so it's odd while
+  //a writer is active; lets update waiters detect releases that happen
+  //between their own release and their wait, and doubles as the write
+  //generation for 'get_generation'/'stale_read')
+  std::atomic <unsigned long> updates;
+  bool                     writer, writer_waiting, upgrade_waiting;
+  const void              *the_writer;
+  std::mutex               master_lock;
+  std::condition_variable  read_wait, write_wait, update_wait;
+};
+
+
+//policies for policy_rw_lock (see below)
+
+/*! Waiting writers block out new readers (the \ref rw_lock compromise).*/
+struct rw_write_preference {
+  static const bool prefer_readers = false;
+  static const bool fifo           = false;
+};
+
+/*! New readers proceed whenever no writer holds the lock, even if writers are
+ *  waiting. Maximizes reader throughput; writers can starve under a
+ *  continuous reader load.*/
+struct rw_read_preference {
+  static const bool prefer_readers = true;
+  static const bool fifo           = false;
+};
+
+/*! Strict arrival order: each request waits for every earlier request to be
+ *  granted, with consecutive readers sharing the lock. Bounds writer latency
+ *  by the requests already queued when the writer arrives.*/
+struct rw_fifo_preference {
+  static const bool prefer_readers = false;
+  static const bool fifo           = true;
+};
+
+
+/*! \class policy_rw_lock
+ *  \brief Read-write lock with a selectable fairness policy.
+ *
+ * This lock has the same basic semantics as \ref rw_lock — multiple readers or
+ * one writer, with the same write-lock-holder read exception — but the policy
+ * deciding who waits for whom is a template parameter instead of being fixed:
+ * \ref rw_write_preference matches rw_lock's behavior, \ref rw_read_preference
+ * lets readers stream past waiting writers (e.g., rarely-updated aggregation
+ * containers), and \ref rw_fifo_preference grants strictly in arrival order to
+ * bound writer latency. Select the policy per container via the 'Lock'
+ * argument of \ref locking_container. Unlike \ref rw_lock, this lock doesn't
+ * support upgrading, timed locks, or update waits.
+ */
+
+template <class Policy = rw_write_preference>
+class policy_rw_lock : public lock_base {
+public:
+  using lock_base::count_type;
+
+  policy_rw_lock() : readers(0), readers_waiting(0), writers_waiting(0),
+    next_ticket(0), serving(0), writer(false), the_writer(NULL) {}
+
+private:
+  policy_rw_lock(const policy_rw_lock&);
+  policy_rw_lock &operator = (const policy_rw_lock&);
+
+public:
+  count_type lock(lock_auth_base *auth, bool read, bool block = true, bool test = false) {
+    std::unique_lock <std::mutex> local_lock(master_lock);
+    bool writer_reads = auth && the_writer == auth && read;
+    bool lock_out     = writers_waiting || readers_waiting;
+    bool must_block   = this->would_block(read);
+    lock_data l(this, block, read, !writer_reads && lock_out,
+      !writer_reads && must_block, this->get_order());
+    //make sure this is an authorized lock type for the caller
+    if (!register_or_test_auth(auth, l, test)) {
+      return -1;
+    }
+    block = l.block; //(auth. can override blocking mode to allow lock attempt)
+    //exception to blocking: if 'auth' holds the write lock and a read is requested
+    if (!writer_reads && !block && must_block) {
+      if (!test) release_auth(auth, l);
+      return -1;
+    }
+    if (writer_reads) {
+      count_type new_readers = ++readers;
+      assert(readers > 0);
+      return new_readers;
+    }
+    if (Policy::fifo) {
+      //take the next ticket and wait for every earlier request to be granted;
+      //a granted reader advances 'serving' immediately so that a run of
+      //readers at the front of the line shares the lock, while a granted
+      //writer only advances it when it unlocks
+      count_type ticket = next_ticket++;
+      while (serving != ticket) {
+        gate_wait.wait(local_lock);
+      }
+      if (read) {
+        ++serving;
+        gate_wait.notify_all();
+        //('serving' can't pass a writer's ticket while it holds the lock)
+        assert(!writer);
+        count_type new_readers = ++readers;
+        assert(readers > 0);
+        return new_readers;
+      } else {
+        while (writer || readers) {
+          write_wait.wait(local_lock);
+        }
+        writer = true;
+        the_writer = auth;
+        return 0;
+      }
+    }
+    if (read) {
+      //get a read lock
+      ++readers_waiting;
+      assert(readers_waiting > 0);
+      while (writer || (!Policy::prefer_readers && writers_waiting)) {
+        read_wait.wait(local_lock);
+      }
+      --readers_waiting;
+      count_type new_readers = ++readers;
+      assert(!writer && readers > 0);
+      return new_readers;
+    } else {
+      //get a write lock
+      ++writers_waiting;
+      assert(writers_waiting > 0);
+      while (writer || readers) {
+        write_wait.wait(local_lock);
+      }
+      --writers_waiting;
+      writer = true;
+      the_writer = auth;
+      return 0;
+    }
+  }
+
+  count_type unlock(lock_auth_base *auth, bool read, bool test = false) {
+    std::unique_lock <std::mutex> local_lock(master_lock);
+    if (!test) {
+      unlock_data l(this, read, this->get_order());
+      release_auth(auth, l);
+    }
+    if (read) {
+      assert(((auth && the_writer == auth) || !writer) && readers > 0);
+      count_type new_readers = --readers;
+      if (!new_readers && (Policy::fifo || writers_waiting)) {
+        write_wait.notify_all();
+      }
+      return new_readers;
+    } else {
+      assert(writer && ((auth && the_writer == auth) || !readers));
+      assert(the_writer == auth);
+      writer = false;
+      the_writer = NULL;
+      if (Policy::fifo) {
+        //(the writer's ticket is retired; the next request in line proceeds)
+        ++serving;
+        gate_wait.notify_all();
+      } else {
+        //NOTE: both groups are notified either way; under write preference the
+        //woken readers recheck 'writers_waiting' and park again, and under
+        //read preference a woken writer rechecks 'readers'
+        if (writers_waiting) write_wait.notify_all();
+        if (readers_waiting) read_wait.notify_all();
+      }
+      return 0;
+    }
+  }
+
+  ~policy_rw_lock() {
+    assert(!readers && !readers_waiting && !writers_waiting && !writer);
+  }
+
+private:
+  bool would_block(bool read) const {
+    if (Policy::fifo) {
+      //(someone is already in line, or the lock itself is unavailable)
+      return next_ticket != serving || (read? writer : (writer || (readers != 0)));
+    }
+    if (read) return writer || (!Policy::prefer_readers && writers_waiting);
+    return writer || readers;
+  }
+
+  count_type               readers, readers_waiting, writers_waiting;
+  //(FIFO arrival order; 'serving' trails 'next_ticket' by the queue length)
+  count_type               next_ticket, serving;
+  bool                     writer;
+  const void              *the_writer;
+  std::mutex               master_lock;
+  std::condition_variable  read_wait, write_wait, gate_wait;
+};
+
+typedef policy_rw_lock <rw_read_preference> reader_pref_rw_lock;
+typedef policy_rw_lock <rw_fifo_preference> fifo_rw_lock;
+
+
+/*! \class fast_rw_lock
+ *  \brief Lock object that allows multiple readers at once, optimized for the
+ *  uncontended case.
+ *
+ * This lock has the same semantics as \ref rw_lock, but uncontended read and
+ * write locks are obtained with a single atomic compare-and-swap on a packed
+ * state word instead of a mutex round-trip. The mutex and condition variables
+ * are only used when a thread actually has to wait. The trade-off is that the
+ * lock-out heuristics passed to the auth. object are computed from an atomic
+ * snapshot rather than under the lock's mutex; when a blocking request would
+ * actually have to wait, the auth. is re-consulted under the mutex with
+ * conservative values, so deadlock prevention errs toward rejecting the lock.
+ * Unlike \ref rw_lock, a waiting writer only blocks out new readers until they
+ * reach the slow path; this favors reader throughput over writer latency.
+ */
+
+class fast_rw_lock : public lock_base {
+public:
+  using lock_base::count_type;
+
+  fast_rw_lock();
+
+private:
+  fast_rw_lock(const fast_rw_lock&);
+  fast_rw_lock &operator = (const fast_rw_lock&);
+
+public:
+  count_type lock(lock_auth_base *auth, bool read, bool block = true, bool test = false);
+  count_type unlock(lock_auth_base *auth, bool read, bool test = false);
+
+  ~fast_rw_lock();
+
+private:
+  count_type lock_slow(lock_auth_base *auth, bool read, bool block, bool test);
+
+  //(-1: write-locked; 0: free; > 0: number of readers)
+  //NOTE: this is the word hammered by every reader and writer on the fast
+  //path; keeping it on its own cache line stops those compare-and-swaps from
+  //invalidating the lines holding the fields below (and vice versa)
+  alignas(cache_line_size) std::atomic <count_type>  state;
+  //(threads in the slow path; checked by the unlock fast path)
+  alignas(cache_line_size) std::atomic <count_type>  waiting;
+  //(read locks held by the current writer; see 'rw_lock' re. 'writer_reads')
+  std::atomic <count_type>  writer_reads;
+  std::atomic <const void*> the_writer;
+  //(these are only modified with 'master_lock' held)
+  count_type                readers_waiting, writers_waiting;
+  std::mutex                master_lock;
+  std::condition_variable   read_wait, write_wait;
+};
+
+
+/*! \class sharded_rw_lock
+ *  \brief Lock object that allows multiple readers at once, optimized for
+ *  read-mostly use on many cores.
+ *
+ * This lock has the same semantics as \ref rw_lock, but the reader count is
+ * sharded across several cache lines instead of living behind one mutex: a
+ * read lock is an increment of the calling thread's shard followed by a check
+ * of a writer-presence flag, so concurrent readers on different cores don't
+ * touch each other's cache lines at all. A reader can increment one shard when
+ * locking and decrement another when unlocking (e.g., after a proxy is moved
+ * between threads); only the sum across shards is meaningful, which is why the
+ * per-shard counts are signed. Writers raise the flag, then wait for the
+ * shard counts to drain to zero, so write locks are substantially more
+ * expensive than \ref rw_lock write locks — use this lock when reads vastly
+ * outnumber writes, e.g., as the lock behind \ref fast_meta_lock, where every
+ * multi-capable acquisition in the process takes a read lock and writes only
+ * happen for multi-container operations.
+ */
+
+class sharded_rw_lock : public lock_base {
+public:
+  using lock_base::count_type;
+
+  sharded_rw_lock();
+
+private:
+  sharded_rw_lock(const sharded_rw_lock&);
+  sharded_rw_lock &operator = (const sharded_rw_lock&);
+
+public:
+  count_type lock(lock_auth_base *auth, bool read, bool block = true, bool test = false);
+  count_type unlock(lock_auth_base *auth, bool read, bool test = false);
+
+  ~sharded_rw_lock();
+
+private:
+  count_type lock_read_slow(lock_auth_base *auth, bool block, bool test);
+  count_type sum_shards() const;
+  static std::size_t this_shard();
+
+  static const std::size_t shard_count = 16;
+
+  struct alignas(cache_line_size) shard_type {
+    shard_type() : readers(0) {}
+    std::atomic <count_type> readers;
+  };
+
+  //(per-shard reader counts; hot path of every read lock and unlock)
+  shard_type shards[shard_count];
+  //(true whenever 'writer' is set or a writer is waiting; read locks that see
+  //it raised fall back to the mutex below)
+  alignas(cache_line_size) std::atomic <bool> writer_present;
+  //(these are only modified with 'master_lock' held)
+  bool                     writer;
+  count_type               writers_waiting, writer_reads;
   const void              *the_writer;
   std::mutex               master_lock;
   std::condition_variable  read_wait, write_wait;
@@ -157,7 +568,8 @@ class w_lock : public lock_base {
 public:
   using lock_base::count_type;
 
-  w_lock();
+  /*! \param new_spin_limit Spin rounds before parking (see \ref rw_lock).*/
+  explicit w_lock(unsigned int new_spin_limit = 0);
 
 private:
   w_lock(const w_lock&);
@@ -168,9 +580,16 @@ public:
 
   count_type unlock(lock_auth_base *auth, bool read, bool test = false);
 
+  count_type lock_until(lock_auth_base *auth, bool read,
+    std::chrono::steady_clock::time_point deadline, bool test = false);
+
   ~w_lock();
 
 private:
+  count_type lock_internal(lock_auth_base *auth, bool block, bool test,
+    const std::chrono::steady_clock::time_point *deadline);
+
+  const unsigned int      spin_limit;
   bool                    writer;
   count_type              writers_waiting;
   std::mutex              master_lock;
@@ -213,6 +632,12 @@ public:
     return this->base::unlock(auth, read, test);
   }
 
+  count_type lock_until(lock_auth_base *auth, bool read,
+    std::chrono::steady_clock::time_point deadline, bool test = false) {
+    if (!auth) return -1;
+    return this->base::lock_until(auth, read, deadline, test);
+  }
+
   virtual order_type get_order() const {
     return order;
   }
@@ -225,6 +650,322 @@ private:
 };
 
 
+/*! \class static_ordered_lock
+ *  \brief Lock object whose locking order is fixed at compile time.
+ *
+ * This lock is the same as Base (first template argument), except its order
+ * (see \ref ordered_lock) is a template parameter rather than a constructor
+ * argument. When a lock hierarchy is fixed at compile time this removes the
+ * per-acquisition order bookkeeping entirely: the compile-time checked
+ * \ref get_two_locks and \ref get_all_locks overloads validate the
+ * acquisition order with static_asserts, and
+ * 'lock_auth <static_ordered_lock <...> >' therefore doesn't track held
+ * orders at runtime the way 'lock_auth <ordered_lock <...> >' does.
+ * \attention The compile-time checks only cover acquisitions made through
+ * \ref get_two_locks and \ref get_all_locks; code that locks these containers
+ * by hand must respect ascending order itself, since the auth. won't reject
+ * out-of-order locks at runtime.
+ */
+
+template <class Base, lock_base::order_type Order>
+class static_ordered_lock : public Base {
+  static_assert(Order > 0, "static_ordered_lock requires a non-zero order");
+
+private:
+  typedef Base base;
+
+public:
+  using typename base::count_type;
+  using typename base::order_type;
+
+  static const order_type lock_order = Order;
+
+  static_ordered_lock() {}
+
+  //(for bases with constructor arguments, e.g., 'rw_lock' spin rounds)
+  template <class ... Args>
+  explicit static_ordered_lock(Args ... args) : base(args...) {}
+
+  virtual order_type get_order() const {
+    return Order;
+  }
+
+private:
+  static_ordered_lock(const static_ordered_lock&);
+  static_ordered_lock &operator = (const static_ordered_lock&);
+};
+
+template <class Base, lock_base::order_type Order>
+const typename static_ordered_lock <Base, Order> ::order_type
+  static_ordered_lock <Base, Order> ::lock_order;
+
+
+/*! \struct static_lock_order
+ *  \brief Compile-time locking order of a lock type.
+ *
+ * This is the order of a \ref static_ordered_lock, or 0 for lock types whose
+ * order isn't known at compile time (including \ref ordered_lock). Wrappers
+ * that don't change locking semantics pass the order of their base through.
+ */
+
+template <class> class instrumented_lock;
+template <class> class padded_lock;
+
+template <class Lock>
+struct static_lock_order {
+  static const lock_base::order_type value = 0;
+};
+
+template <class Base, lock_base::order_type Order>
+struct static_lock_order <static_ordered_lock <Base, Order> > {
+  static const lock_base::order_type value = Order;
+};
+
+template <class Base>
+struct static_lock_order <instrumented_lock <Base> > : static_lock_order <Base> {};
+
+template <class Base>
+struct static_lock_order <padded_lock <Base> > : static_lock_order <Base> {};
+
+
+/*! \struct lock_stats
+ *  \brief Snapshot of one instrumented lock's counters.
+ *
+ * Wait times are recorded in a logarithmic histogram: bucket 0 counts waits
+ * shorter than one microsecond, and bucket i > 0 counts waits of at least
+ * 2^(i-1) and less than 2^i microseconds (the last bucket absorbs everything
+ * longer).
+ */
+
+struct lock_stats {
+  typedef unsigned long long counter_type;
+
+  static const unsigned int histogram_size = 16;
+
+  lock_stats() : acquisitions(0), contended(0), failures(0) {
+    for (unsigned int i = 0; i < histogram_size; i++) wait_histogram[i] = 0;
+  }
+
+  /*! Successful lock operations.*/
+  counter_type acquisitions;
+  /*! Successful lock operations that had to wait for another holder.*/
+  counter_type contended;
+  /*! Failed lock attempts, e.g., failed try-locks and auth. denials.*/
+  counter_type failures;
+  /*! Wait times of contended acquisitions (see above).*/
+  counter_type wait_histogram[histogram_size];
+};
+
+
+/*! \class instrumented_lock_base
+ *  \brief Non-template portion of \ref instrumented_lock.
+ *
+ * This holds the counters for one lock instance and registers the instance
+ * with \ref lock_registry for its lifetime.
+ */
+
+class instrumented_lock_base {
+public:
+  explicit instrumented_lock_base(const std::string &new_name);
+
+  /*! Get a consistent snapshot of this lock's counters.*/
+  lock_stats get_stats() const;
+
+  const std::string &get_name() const;
+
+  virtual ~instrumented_lock_base();
+
+protected:
+  void record_acquisition();
+  void record_contention(lock_stats::counter_type wait_us);
+  void record_failure();
+
+private:
+  instrumented_lock_base(const instrumented_lock_base&);
+  instrumented_lock_base &operator = (const instrumented_lock_base&);
+
+  const std::string  name;
+  mutable std::mutex stats_lock;
+  lock_stats         stats;
+};
+
+
+/*! \class lock_registry
+ *  \brief Process-wide registry of \ref instrumented_lock instances.
+ *
+ * Every \ref instrumented_lock registers itself here for its lifetime, which
+ * allows the contended containers in a process to be found at runtime without
+ * external profiling. The registry is only aware of locks that opted into
+ * instrumentation; uninstrumented locks cost nothing.
+ */
+
+class lock_registry {
+public:
+  /*! Get a snapshot of the names and counters of all registered locks.*/
+  static std::vector <std::pair <std::string, lock_stats> > capture();
+
+private:
+  friend class instrumented_lock_base;
+
+  lock_registry() {}
+  lock_registry(const lock_registry&);
+  lock_registry &operator = (const lock_registry&);
+
+  static void add(instrumented_lock_base *lock);
+  static void remove(instrumented_lock_base *lock);
+
+  static lock_registry &get();
+
+  std::mutex                                   master_lock;
+  std::vector <const instrumented_lock_base*>  locks;
+};
+
+
+/*! \class instrumented_lock
+ *  \brief Lock wrapper that counts acquisitions, contention, and wait times.
+ *
+ * This lock is the same as Base (first template argument), except every lock
+ * operation updates the per-instance counters in \ref lock_stats and the
+ * instance is visible through \ref lock_registry under the name given at
+ * construction. A lock operation counts as contended when an initial try-lock
+ * fails and the subsequent blocking acquisition has to wait; the wait is timed
+ * and added to the histogram. Instrumentation is strictly opt-in: the
+ * unwrapped lock types are untouched, so the zero-overhead default is
+ * preserved.
+ */
+
+template <class Base = rw_lock>
+class instrumented_lock : public Base, public instrumented_lock_base {
+private:
+  typedef Base base;
+
+public:
+  using typename base::count_type;
+
+  explicit instrumented_lock(const std::string &new_name) :
+    instrumented_lock_base(new_name) {}
+
+  //(for bases with constructor arguments, e.g., 'ordered_lock')
+  template <class ... Args>
+  instrumented_lock(const std::string &new_name, Args ... args) :
+    base(args...), instrumented_lock_base(new_name) {}
+
+  count_type lock(lock_auth_base *auth, bool read, bool block = true, bool test = false) {
+    //(auth.-only tests don't touch the lock; don't count them)
+    if (test) return this->base::lock(auth, read, block, true);
+    //probe with a try-lock first so that contention is detected explicitly
+    count_type result = this->base::lock(auth, read, false);
+    if (result >= 0) {
+      this->record_acquisition();
+      return result;
+    }
+    if (!block) {
+      this->record_failure();
+      return result;
+    }
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    result = this->base::lock(auth, read, true);
+    if (result >= 0) {
+      this->record_contention(std::chrono::duration_cast <std::chrono::microseconds> (
+        std::chrono::steady_clock::now() - start).count());
+    } else {
+      this->record_failure();
+    }
+    return result;
+  }
+
+private:
+  instrumented_lock(const instrumented_lock&);
+  instrumented_lock &operator = (const instrumented_lock&);
+};
+
+
+/*! \class padded_lock
+ *  \brief Lock wrapper that pads the lock out to full cache lines.
+ *
+ * This lock is the same as Base (first template argument), except the object
+ * is aligned to (and therefore padded out to a multiple of) \ref
+ * cache_line_size. In a \ref locking_container this keeps the lock's state off
+ * of the cache line holding the start of the contained object, and it keeps
+ * adjacent containers (e.g., elements of an array of containers) from sharing
+ * cache lines with each other. Padding is strictly opt-in: the unwrapped lock
+ * types are untouched, so containers that don't need it pay nothing.
+ * \attention Over-aligned types require aligned allocation support when
+ * allocated on the heap; in C++11, either keep padded containers in static,
+ * stack, or member storage, or allocate them with a suitable allocator.
+ */
+
+template <class Base = rw_lock>
+class alignas(cache_line_size) padded_lock : public Base {
+private:
+  typedef Base base;
+
+public:
+  using typename base::count_type;
+
+  padded_lock() {}
+
+  //(for bases with constructor arguments, e.g., 'ordered_lock')
+  template <class ... Args>
+  explicit padded_lock(Args ... args) : base(args...) {}
+
+private:
+  padded_lock(const padded_lock&);
+  padded_lock &operator = (const padded_lock&);
+};
+
+typedef padded_lock <rw_lock> padded_rw_lock;
+
+
+/*! \class seq_lock
+ *  \brief Sequence lock for optimistic reads of small objects.
+ *
+ * This lock only grants write locks through the \ref lock_base interface;
+ * read lock requests always fail. Readers instead validate optimistic
+ * snapshots against the lock's sequence counter using \ref read_begin and
+ * \ref read_retry: the counter is odd while a writer is active and
+ * incremented again when it finishes, so a reader whose counter changed
+ * must retry its copy. Readers never write shared state, so they scale
+ * with the number of cores. Use \ref seqlock_container rather than using
+ * this lock directly; reading the protected object without the validation
+ * loop is a data race.
+ */
+
+class seq_lock : public lock_base {
+public:
+  using lock_base::count_type;
+
+  seq_lock();
+
+private:
+  seq_lock(const seq_lock&);
+  seq_lock &operator = (const seq_lock&);
+
+public:
+  count_type lock(lock_auth_base *auth, bool read, bool block = true, bool test = false);
+  count_type unlock(lock_auth_base *auth, bool read, bool test = false);
+
+  /*! Wait until no writer is active and return the current sequence value.*/
+  count_type read_begin() const;
+
+  /*! Check whether a snapshot taken after \ref read_begin must be retried.*/
+  bool read_retry(count_type sequence_value) const;
+
+  /*! \brief Current write generation (see \ref lock_base::get_generation).
+   *
+   * The sequence counter already is a write generation, so this just reads
+   * it.
+   */
+  count_type get_generation() const;
+
+  ~seq_lock();
+
+private:
+  std::atomic <count_type> sequence;
+  std::mutex               master_lock;
+};
+
+
 /*! \class dumb_lock
  *  \brief Lock object that doesn't track readers and writers.
  *
@@ -249,11 +990,77 @@ private:
 public:
   count_type lock(lock_auth_base *auth, bool read, bool block = true, bool test = false);
   count_type unlock(lock_auth_base *auth, bool read, bool test = false);
+  count_type lock_until(lock_auth_base *auth, bool read,
+    std::chrono::steady_clock::time_point deadline, bool test = false);
 
   ~dumb_lock();
 
 private:
-  std::mutex master_lock;
+  //(timed so that 'lock_until' can be supported)
+  std::timed_mutex master_lock;
+};
+
+
+/*! \class null_lock
+ *  \brief Lock object that doesn't lock at all.
+ *
+ * This lock unconditionally grants every request without tracking anything,
+ * for code that keeps the \ref locking_container API for uniformity but runs
+ * strictly single-threaded (e.g., a dedicated thread per container). A
+ * container using this lock compiles down to bare object access — no atomic
+ * or mutex instructions — while remaining compatible with the proxy API,
+ * \ref get_two_locks, and \ref try_copy_container. Auth. objects are still
+ * registered if passed, so containers shared between the single-threaded and
+ * concurrent parts of a program shouldn't use this lock.
+ * \attention This provides no thread safety whatsoever.
+ */
+
+//NOTE: defined inline, unlike the other non-template locks, so that calls can
+//collapse to a constant in the container's accessors
+
+class null_lock : public lock_base {
+public:
+  using lock_base::count_type;
+
+  null_lock() {}
+
+private:
+  null_lock(const null_lock&);
+  null_lock &operator = (const null_lock&);
+
+public:
+  count_type lock(lock_auth_base *auth, bool read, bool block = true, bool test = false) {
+    //(the container is never in use as far as the auth. is concerned)
+    lock_data l(this, block, read, false, false, this->get_order());
+    if (!register_or_test_auth(auth, l, test)) return -1;
+    return read? 1 : 0;
+  }
+
+  count_type unlock(lock_auth_base *auth, bool read, bool test = false) {
+    if (!test) {
+      unlock_data l(this, read, this->get_order());
+      release_auth(auth, l);
+    }
+    return 0;
+  }
+
+  count_type lock_until(lock_auth_base *auth, bool read,
+    std::chrono::steady_clock::time_point /*deadline*/, bool test = false) {
+    return this->lock(auth, read, true, test);
+  }
+
+  count_type upgrade(lock_auth_base *auth, bool /*block*/ = true) {
+    //(nothing contends, so a promotion is trivially granted)
+    unlock_data l(this, true, this->get_order());
+    release_auth(auth, l);
+    lock_data w(this, true, false, false, false, this->get_order());
+    if (!register_or_test_auth(auth, w, false)) {
+      lock_data r(this, true, true, false, false, this->get_order());
+      register_or_test_auth(auth, r, false);
+      return -1;
+    }
+    return 0;
+  }
 };
 
 
@@ -64,6 +64,9 @@ protected:
 
 private:
   template <class> friend class locking_container_base;
+  template <class, class> friend class locking_container;
+  template <class, class> friend class static_locking_container;
+  template <class, class> friend class locking_array;
 
   virtual lock_base *get_lock_object() = 0;
 };
@@ -105,6 +108,137 @@ private:
   rw_lock locks;
 };
 
+
+/*! \class fast_meta_lock
+ *  \brief Scalable drop-in replacement for \ref meta_lock.
+ *
+ * This behaves exactly like \ref meta_lock, but it's backed by a
+ * \ref sharded_rw_lock instead of a \ref rw_lock. Every multi-capable
+ * container acquisition read-locks the meta-lock, so with \ref meta_lock the
+ * single mutex inside its \ref rw_lock becomes the process-wide bottleneck on
+ * machines with many cores, even when the containers themselves are
+ * uncontended. Here the read side is an increment of a per-thread counter
+ * shard, so unrelated acquisitions don't contend with each other at all. The
+ * trade-off is that write locks — i.e., actual multi-container operations
+ * such as \ref try_copy_container — are more expensive, since the writer has
+ * to drain all of the counter shards.
+ */
+
+class fast_meta_lock : public meta_lock_base {
+private:
+  typedef lock_auth <sharded_rw_lock> auth_base_type;
+
+public:
+  typedef meta_lock_base base;
+  using base::write_proxy;
+  using base::read_proxy;
+  using base::auth_type;
+  using base::get_write_auth;
+
+  inline fast_meta_lock() {}
+
+private:
+  fast_meta_lock(const fast_meta_lock&);
+  fast_meta_lock &operator = (const fast_meta_lock&);
+
+  inline write_proxy get_write_auth(lock_auth_base *authorization, bool block = true) {
+    return write_proxy(true, &locks, authorization, false, block, NULL);
+  }
+
+  inline read_proxy get_read_auth(lock_auth_base *authorization, bool block = true) {
+    return read_proxy(true, &locks, authorization, true, block, NULL);
+  }
+
+  inline lock_base *get_lock_object() {
+    return &locks;
+  }
+
+  sharded_rw_lock locks;
+};
+
+
+/*! \class meta_lock_tree
+ *  \brief Hierarchical \ref meta_lock scope.
+ *
+ * A single \ref meta_lock serializes every multi-lock operation in the
+ * process on one lock, even when the operations touch disjoint sets of
+ * containers. This class splits that lock into a tree of scopes: each
+ * instance is one scope, constructed either as a root or as the child of
+ * another scope, and containers register under the scope covering their
+ * subsystem by using it as their multi-lock. A multi-lock operation then
+ * write-locks the narrowest scope covering its containers. Scopes only
+ * synchronize along ancestor/descendant paths — every operation on a scope
+ * also read-locks the scope's ancestor path — so a write on a scope excludes
+ * container locks and writes in its own subtree and writes on its ancestors,
+ * while scopes in disjoint subtrees share nothing but read locks on common
+ * ancestors and proceed fully in parallel. Path locks are always taken in
+ * root-to-leaf order, so meta-lock operations on one tree can't deadlock
+ * against each other.
+ *
+ * \attention The exclusivity guarantee of a write lock (see
+ * \ref locking_container_base::get_write_multi) covers exactly the containers
+ * registered under the written scope's subtree — not containers registered
+ * under disjoint scopes. All of the threads operating on one subsystem must
+ * therefore agree on the scope that covers it.
+ * \attention A parent scope must outlive its children.
+ */
+
+class meta_lock_tree : public meta_lock_base {
+private:
+  typedef lock_auth <rw_lock> auth_base_type;
+
+public:
+  typedef meta_lock_base base;
+  using base::write_proxy;
+  using base::read_proxy;
+  using base::auth_type;
+  using base::get_write_auth;
+
+  /*! Create a root scope.*/
+  inline meta_lock_tree() : parent(NULL), scope(*this) {}
+
+  /*! Create a child scope of an existing scope.*/
+  explicit inline meta_lock_tree(meta_lock_tree &new_parent) :
+    parent(&new_parent), scope(*this) {}
+
+private:
+  meta_lock_tree(const meta_lock_tree&);
+  meta_lock_tree &operator = (const meta_lock_tree&);
+
+  inline write_proxy get_write_auth(lock_auth_base *authorization, bool block = true) {
+    return write_proxy(true, &scope, authorization, false, block, NULL);
+  }
+
+  inline read_proxy get_read_auth(lock_auth_base *authorization, bool block = true) {
+    return read_proxy(true, &scope, authorization, true, block, NULL);
+  }
+
+  inline lock_base *get_lock_object() {
+    return &scope;
+  }
+
+  //(the lock containers and proxies actually interact with; every operation
+  //on it also read-locks the scope's ancestor path, root first)
+  class tree_path_lock : public lock_base {
+  public:
+    tree_path_lock(meta_lock_tree &new_owner) : owner(new_owner) {}
+
+    count_type lock(lock_auth_base *auth, bool read, bool block = true, bool test = false);
+    count_type unlock(lock_auth_base *auth, bool read, bool test = false);
+
+  private:
+    meta_lock_tree &owner;
+  };
+  friend class tree_path_lock;
+
+  bool hold_path(lock_auth_base *auth, bool block);
+  void release_path(lock_auth_base *auth);
+
+  meta_lock_tree *const parent;
+  rw_lock               locks;
+  tree_path_lock        scope;
+};
+
 } //namespace lc
 
 #endif //lc_meta_lock_hpp
@@ -33,8 +33,11 @@
 #ifndef lc_object_proxy_hpp
 #define lc_object_proxy_hpp
 
+#include <atomic>
 #include <memory>
 
+#include <string.h>
+
 #include "locks.hpp"
 
 namespace lc {
@@ -53,6 +56,12 @@ public:
     bool new_read, bool block, lock_base *new_multi) :
     container_lock(new locker(new_pointer, new_locks, new_auth, new_read, block, new_multi)) {}
 
+  //(adopts a lock already held, e.g., by an upgraded read proxy or a timed
+  //container accessor)
+  object_proxy_base(Type *new_pointer, lock_base *new_locks, lock_auth_base *new_auth,
+    bool new_read, lock_base *new_multi) :
+    container_lock(new locker(new_pointer, new_locks, new_auth, new_read, new_multi)) {}
+
   inline int last_lock_count() const {
     //(mostly provided for debugging)
     return container_lock? container_lock->lock_count : 0;
@@ -71,6 +80,39 @@ protected:
     return container_lock? container_lock->pointer : 0;
   }
 
+  //(support for object_proxy upgrades: promote the held read lock to a write
+  //lock in place; on success this proxy gives up responsibility for unlocking,
+  //which passes to the caller via the returned lock state)
+  bool upgrade_lock(bool block, lock_base *&new_locks, lock_auth_base *&new_auth,
+    lock_base *&new_multi) {
+    //the promotion would silently upend other proxies sharing this lock state
+    if (!container_lock || container_lock.use_count() != 1) return false;
+    if (!container_lock->read || !container_lock->locks)    return false;
+    if (container_lock->locks->upgrade(container_lock->auth, block) < 0) return false;
+    new_locks = container_lock->locks;
+    new_auth  = container_lock->auth;
+    new_multi = container_lock->multi;
+    //(the new write proxy takes over unlock duties)
+    container_lock->opt_out(false, false);
+    container_lock.reset();
+    return true;
+  }
+
+  //(support for proxy_group: the group takes over unlock duties and this
+  //proxy becomes empty; fails if other proxy copies share the lock state)
+  bool transfer_lock(bool &new_read, lock_base *&new_locks, lock_auth_base *&new_auth,
+    lock_base *&new_multi) {
+    if (!container_lock || container_lock.use_count() != 1) return false;
+    if (!container_lock->locks) return false;
+    new_read  = container_lock->read;
+    new_locks = container_lock->locks;
+    new_auth  = container_lock->auth;
+    new_multi = container_lock->multi;
+    container_lock->opt_out(false, false);
+    container_lock.reset();
+    return true;
+  }
+
 private:
   class locker {
   public:
@@ -85,6 +127,13 @@ private:
       if (!locks || (lock_count = locks->lock(auth, read, block)) < 0) this->opt_out(false);
     }
 
+    //(adopts a lock already held, e.g., by an upgraded read proxy or a timed
+    //container accessor)
+    locker(Type *new_pointer, lock_base *new_locks, lock_auth_base *new_auth,
+      bool new_read, lock_base *new_multi) :
+      pointer(new_pointer), lock_count(), read(new_read), locks(new_locks),
+      multi(new_multi), auth(new_auth) {}
+
     int last_lock_count() const {
       //(mostly provided for debugging)
       return lock_count;
@@ -112,6 +161,8 @@ private:
     int   lock_count;
 
   private:
+    friend class object_proxy_base;
+
     locker(const locker&);
     locker &operator = (const locker&);
 
@@ -138,11 +189,21 @@ template <class Type>
 class object_proxy : public object_proxy_base <Type> {
 private:
   template <class, class> friend class locking_container;
+  template <class, class> friend class locking_array;
+  template <class>        friend class shared_container;
+  template <class>        friend class object_proxy;
+  friend class proxy_group;
 
   object_proxy(Type *new_pointer, lock_base *new_locks, lock_auth_base *new_auth,
     bool read, bool block, lock_base *new_multi) :
     object_proxy_base <Type> (new_pointer, new_locks, new_auth, read, block, new_multi) {}
 
+  //(adopts a lock already held, e.g., by an upgraded read proxy or a timed
+  //container accessor)
+  object_proxy(Type *new_pointer, lock_base *new_locks, lock_auth_base *new_auth,
+    bool read, lock_base *new_multi) :
+    object_proxy_base <Type> (new_pointer, new_locks, new_auth, read, new_multi) {}
+
 public:
   object_proxy() : object_proxy_base <Type> () {}
 
@@ -235,11 +296,19 @@ template <class Type>
 class object_proxy <const Type> : public object_proxy_base <const Type> {
 private:
   template <class, class> friend class locking_container;
+  template <class, class> friend class locking_array;
+  template <class>        friend class shared_container;
+  friend class proxy_group;
 
   object_proxy(const Type *new_pointer, lock_base *new_locks, lock_auth_base *new_auth,
     bool read, bool block, lock_base *new_multi) :
     object_proxy_base <const Type> (new_pointer, new_locks, new_auth, read, block, new_multi) {}
 
+  //(adopts a lock already held, e.g., by a timed container accessor)
+  object_proxy(const Type *new_pointer, lock_base *new_locks, lock_auth_base *new_auth,
+    bool read, lock_base *new_multi) :
+    object_proxy_base <const Type> (new_pointer, new_locks, new_auth, read, new_multi) {}
+
 public:
   object_proxy() : object_proxy_base <const Type> () {}
 
@@ -312,6 +381,29 @@ public:
 
   //@}
 
+  /*! \brief Atomically promote this read proxy to a write proxy.
+   *
+   * This succeeds only if the container's lock supports upgrading (e.g.,
+   * \ref rw_lock), this proxy is the sole reference to its lock state, and the
+   * deadlock-prevention rules allow waiting for the other readers to leave.
+   * On success this proxy is cleared, the returned write proxy takes over the
+   * (now exclusive) lock, and no writer can have modified the object since
+   * this proxy was obtained. On failure this proxy retains its read lock.
+   *
+   * \param block Should the call block for the promotion?
+   *
+   * \return proxy object
+   */
+  inline object_proxy <Type> upgrade(bool block = true) {
+    Type *object = const_cast <Type*> (this->pointer());
+    lock_base      *new_locks = NULL, *new_multi = NULL;
+    lock_auth_base *new_auth  = NULL;
+    if (!this->upgrade_lock(block, new_locks, new_auth, new_multi)) {
+      return object_proxy <Type> ();
+    }
+    return object_proxy <Type> (object, new_locks, new_auth, false, new_multi);
+  }
+
   /** @name Trivial Iterator Functions
    *
    */
@@ -325,11 +417,314 @@ public:
 };
 
 
+/*! \class proxy_group
+ *  \brief Collection that owns proxies and releases them in one batch.
+ *
+ * Code that gathers proxies on many containers and releases them together
+ * (e.g., at the end of a processing tick) pays one mutex round-trip per proxy
+ * when the proxies are destructed individually. Adding a proxy to a
+ * proxy_group instead transfers its unlock responsibility to the group (the
+ * proxy itself becomes empty); \ref release then sorts the held locks so that
+ * all references to the same lock held the same way are released with a
+ * single \ref lock_base::unlock_batch call — one mutex acquisition per lock,
+ * with the per-reference auth. releases folded into it — and meta-lock
+ * references are batched the same way across all of the group's proxies.
+ * \attention A proxy that shares its lock state with other proxy copies can't
+ * be transferred; \ref add fails and leaves it untouched.
+ */
+
+class proxy_group {
+public:
+  proxy_group() {}
+
+  /*! \brief Take over a proxy's locks.
+   *
+   * On success the proxy is left empty and its locks are released by the next
+   * \ref release (or by the group's destructor).
+   *
+   * \return success (true) or failure (false); on failure the proxy is
+   * unchanged and releases its locks as usual
+   */
+  template <class Type>
+  bool add(object_proxy <Type> &proxy) {
+    held_lock entry = { NULL, NULL, NULL, true };
+    if (!proxy.transfer_lock(entry.read, entry.locks, entry.auth, entry.multi)) {
+      return false;
+    }
+    held.push_back(entry);
+    return true;
+  }
+
+  /*! Number of transferred proxies not yet released.*/
+  std::size_t size() const {
+    return held.size();
+  }
+
+  /*! Release everything the group holds, batching by lock.*/
+  void release();
+
+  ~proxy_group() {
+    this->release();
+  }
+
+private:
+  proxy_group(const proxy_group&);
+  proxy_group &operator = (const proxy_group&);
+
+  struct held_lock {
+    lock_base      *locks;
+    lock_auth_base *auth;
+    lock_base      *multi;
+    bool            read;
+  };
+
+  static bool batch_order(const held_lock &left, const held_lock &right);
+  static bool multi_order(const held_lock &left, const held_lock &right);
+
+  std::vector <held_lock> held;
+};
+
+
+/*! \class stale_read
+ *  \brief Unlocked, generation-stamped view of a contained object.
+ *
+ * This isn't a lock-holding proxy: obtaining one records the lock's current
+ * write generation (see \ref lock_base::get_generation) without locking
+ * anything, so writers are never blocked, no matter how long the caller
+ * computes. \ref revalidate then answers whether any write has started since
+ * the stamp was taken — if it returns true, everything read through the view
+ * in between is known to be consistent; if it returns false, the caller
+ * retries. Use \ref read_copy to take a snapshot, or \ref revalidate directly
+ * when the computation reads the object in place.
+ *
+ * \attention Reading through the view can overlap a write, so (as with
+ * \ref seqlock_container) this is only sound for trivially-copyable types,
+ * and values read before a failed \ref revalidate must be discarded, not
+ * used. The view is only valid while the container outlives it.
+ */
+
+template <class Type>
+class stale_read {
+public:
+  typedef lock_auth_base::count_type count_type;
+
+  stale_read() : pointer(NULL), locks(NULL), stamp(-1) {}
+
+  inline operator bool() const {
+    return pointer != NULL;
+  }
+
+  inline bool operator ! () const {
+    return pointer == NULL;
+  }
+
+  inline const Type &operator * () const {
+    return *pointer;
+  }
+
+  inline const Type *operator -> () const {
+    return pointer;
+  }
+
+  /*! \brief Check that no write has started since the view was obtained.
+   *
+   * \return true if everything read through the view so far is consistent
+   */
+  inline bool revalidate() const {
+    if (!pointer) return false;
+    //(order the caller's reads of the object before the recheck; see
+    //seq_lock::read_retry)
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return locks->get_generation() == stamp;
+  }
+
+  /*! \brief Take a validated snapshot of the object.
+   *
+   * \param copy receives the snapshot
+   *
+   * \return true if the snapshot is consistent and can be used
+   */
+  inline bool read_copy(Type &copy) const {
+    if (!pointer) return false;
+    //NOTE: a plain assignment would race with writers; the copy is only used
+    //if 'revalidate' confirms that no write overlapped it
+    memcpy(&copy, pointer, sizeof(Type));
+    return this->revalidate();
+  }
+
+  inline void clear() {
+    pointer = NULL;
+    locks   = NULL;
+    stamp   = -1;
+  }
+
+private:
+  template <class, class> friend class locking_container;
+
+  stale_read(const Type *new_pointer, const lock_base *new_locks) :
+    pointer(new_pointer), locks(new_locks),
+    stamp(locks? locks->get_generation() : -1) {
+    //an odd stamp means a writer was mid-update; < 0 means the lock doesn't
+    //track generations at all — either way nothing can be validated
+    if (stamp < 0 || (stamp & 1)) this->clear();
+  }
+
+  const Type      *pointer;
+  const lock_base *locks;
+  count_type       stamp;
+};
+
+
+/*! \class unique_object_proxy
+ *  \brief Move-only proxy object for \ref locking_container access.
+ *
+ * This behaves like \ref object_proxy, except that the lock state is stored
+ * inline in the proxy instead of behind a reference-counted heap allocation.
+ * This makes the proxy move-only, but obtaining one performs no allocation,
+ * which matters if locks are acquired and released at a very high rate. Use
+ * \ref locking_container::get_write_unique and
+ * \ref locking_container::get_read_unique (and the corresponding auth. and
+ * multi-lock variants) to obtain one.
+ */
+
+template <class Type>
+class unique_object_proxy {
+private:
+  template <class, class> friend class locking_container;
+
+  unique_object_proxy(Type *new_pointer, lock_base *new_locks, lock_auth_base *new_auth,
+    bool new_read, bool block, lock_base *new_multi) :
+    object_pointer(new_pointer), lock_count(), read(new_read), locks(new_locks),
+    multi(new_multi), auth(new_auth) {
+    //attempt to lock the multi-lock if there is one (not counted toward 'auth')
+    if (multi && multi->lock(auth, true, block, true) < 0) this->opt_out(false, false);
+    //attempt to lock the container's lock
+    if (!locks || (lock_count = locks->lock(auth, read, block)) < 0) this->opt_out(false);
+  }
+
+public:
+  unique_object_proxy() : object_pointer(NULL), lock_count(), read(true),
+    locks(NULL), multi(NULL), auth(NULL) {}
+
+  unique_object_proxy(unique_object_proxy &&other) : object_pointer(other.object_pointer),
+    lock_count(other.lock_count), read(other.read), locks(other.locks),
+    multi(other.multi), auth(other.auth) {
+    other.forget();
+  }
+
+  unique_object_proxy &operator = (unique_object_proxy &&other) {
+    if (&other != this) {
+      this->opt_out(true);
+      object_pointer = other.object_pointer;
+      lock_count     = other.lock_count;
+      read           = other.read;
+      locks          = other.locks;
+      multi          = other.multi;
+      auth           = other.auth;
+      other.forget();
+    }
+    return *this;
+  }
+
+private:
+  unique_object_proxy(const unique_object_proxy&);
+  unique_object_proxy &operator = (const unique_object_proxy&);
+
+public:
+  inline int last_lock_count() const {
+    //(mostly provided for debugging)
+    return lock_count;
+  }
+
+  /** @name Checking Referred-to Object
+   *
+   */
+  //@{
+
+  /*! \brief Clear the reference and unlock the container.
+   *
+   * Unlike \ref object_proxy::clear, there are no other references that could
+   * keep the container locked; the container is always unlocked immediately.
+   *
+   * \return *this
+   */
+  inline unique_object_proxy &clear() {
+    this->opt_out(true);
+    return *this;
+  }
+
+  /*! \brief Check if the reference is valid.
+   *
+   * \return valid (true) or invalid (false)
+   */
+  inline operator bool() const {
+    return object_pointer;
+  }
+
+  /*! \brief Check if the reference is invalid.
+   *
+   * \return invalid (true) or valid (false)
+   */
+  inline bool operator ! () const {
+    return !object_pointer;
+  }
+
+  //@}
+
+  /** @name Trivial Iterator Functions
+   *
+   */
+  //@{
+
+  inline operator       Type*()          { return  object_pointer; }
+  inline operator const Type*() const    { return  object_pointer; }
+  inline       Type &operator *()        { return *object_pointer; }
+  inline const Type &operator *() const  { return *object_pointer; }
+  inline       Type *operator ->()       { return  object_pointer; }
+  inline const Type *operator ->() const { return  object_pointer; }
+
+  //@}
+
+  inline ~unique_object_proxy() {
+    this->opt_out(true);
+  }
+
+private:
+  void opt_out(bool unlock1, bool unlock2 = true) {
+    object_pointer = NULL;
+    lock_count     = 0;
+    if (unlock1 && locks) locks->unlock(auth, read);
+    if (unlock2 && multi) multi->unlock(auth, true, true);
+    auth  = NULL;
+    locks = NULL;
+    multi = NULL;
+  }
+
+  //(clear the state without unlocking, e.g., after a move)
+  inline void forget() {
+    object_pointer = NULL;
+    lock_count     = 0;
+    auth           = NULL;
+    locks          = NULL;
+    multi          = NULL;
+  }
+
+  Type            *object_pointer;
+  int              lock_count;
+  bool             read;
+  lock_base       *locks, *multi;
+  lock_auth_base  *auth;
+};
+
+
 class null_container;
 
 template <>
 class object_proxy <void> : public object_proxy_base <void> {
 private:
+  friend class meta_lock;
+  friend class fast_meta_lock;
+  friend class meta_lock_tree;
   friend class meta_lock_write_proxy;
   friend class meta_lock_read_proxy;
 
@@ -357,12 +752,16 @@ public:
 
 class meta_lock_write_proxy : public object_proxy <void> {
   friend class meta_lock;
+  friend class fast_meta_lock;
+  friend class meta_lock_tree;
   using object_proxy <void> ::object_proxy;
 };
 
 
 class meta_lock_read_proxy : public object_proxy <void> {
   friend class meta_lock;
+  friend class fast_meta_lock;
+  friend class meta_lock_tree;
   using object_proxy <void> ::object_proxy;
 };
 
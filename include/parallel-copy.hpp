@@ -0,0 +1,351 @@
+/* This software is released under the BSD License.
+ |
+ | Copyright (c) 2015, Kevin P. Barry [ta0kira@gmail.com]
+ | All rights reserved.
+ |
+ | Redistribution  and  use  in  source  and   binary  forms,  with  or  without
+ | modification, are permitted provided that the following conditions are met:
+ |
+ | - Redistributions of source code must retain the above copyright notice, this
+ |   list of conditions and the following disclaimer.
+ |
+ | - Redistributions in binary  form must reproduce the  above copyright notice,
+ |   this list  of conditions and the following disclaimer in  the documentation
+ |   and/or other materials provided with the distribution.
+ |
+ | - Neither the name  of the  Locking Container Project  nor  the names  of its
+ |   contributors may be  used to endorse or promote products  derived from this
+ |   software without specific prior written permission.
+ |
+ | THIS SOFTWARE IS  PROVIDED BY THE COPYRIGHT HOLDERS AND  CONTRIBUTORS "AS IS"
+ | AND ANY  EXPRESS OR IMPLIED  WARRANTIES,  INCLUDING, BUT  NOT LIMITED TO, THE
+ | IMPLIED WARRANTIES OF  MERCHANTABILITY  AND FITNESS FOR A  PARTICULAR PURPOSE
+ | ARE DISCLAIMED.  IN  NO EVENT SHALL  THE COPYRIGHT  OWNER  OR CONTRIBUTORS BE
+ | LIABLE  FOR  ANY  DIRECT,   INDIRECT,  INCIDENTAL,   SPECIAL,  EXEMPLARY,  OR
+ | CONSEQUENTIAL   DAMAGES  (INCLUDING,  BUT  NOT  LIMITED  TO,  PROCUREMENT  OF
+ | SUBSTITUTE GOODS OR SERVICES;  LOSS  OF USE,  DATA,  OR PROFITS;  OR BUSINESS
+ | INTERRUPTION)  HOWEVER  CAUSED  AND ON  ANY  THEORY OF LIABILITY,  WHETHER IN
+ | CONTRACT,  STRICT  LIABILITY, OR  TORT (INCLUDING  NEGLIGENCE  OR  OTHERWISE)
+ | ARISING IN ANY  WAY OUT OF  THE USE OF THIS SOFTWARE, EVEN  IF ADVISED OF THE
+ | POSSIBILITY OF SUCH DAMAGE.
+ +~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~*/
+
+#ifndef lc_parallel_copy_hpp
+#define lc_parallel_copy_hpp
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+#include "locking-container.hpp"
+
+//NOTE: as with shared-container.hpp, everything here is defined inline in
+//this header (rather than in locking-container.inc) so that the core headers
+//don't grow a dependency on the worker-thread machinery unless bulk copying
+//is actually used
+
+namespace lc {
+
+
+/*! \class thread_pool
+ *  \brief Fixed set of worker threads executing queued tasks.
+ *
+ * This is the minimal pool \ref parallel_copy_containers needs: a fixed
+ * number of workers draining a FIFO task queue. Create one per batch job (or
+ * keep a long-lived one) and pass it to each call; the pool itself holds no
+ * locks between tasks, so it can be shared. The destructor drains the queue
+ * before joining the workers.
+ */
+
+class thread_pool {
+public:
+  explicit thread_pool(std::size_t new_threads) : stopping(false) {
+    if (!new_threads) new_threads = 1;
+    for (std::size_t i = 0; i < new_threads; i++) {
+      workers.emplace_back(&thread_pool::work, this);
+    }
+  }
+
+private:
+  thread_pool(const thread_pool&);
+  thread_pool &operator = (const thread_pool&);
+
+public:
+  std::size_t size() const {
+    return workers.size();
+  }
+
+  /*! Queue a task for execution on some worker thread.*/
+  void execute(std::function <void()> task) {
+    {
+      std::lock_guard <std::mutex> local_lock(master_lock);
+      tasks.push_back(std::move(task));
+    }
+    task_ready.notify_one();
+  }
+
+  ~thread_pool() {
+    {
+      std::lock_guard <std::mutex> local_lock(master_lock);
+      stopping = true;
+    }
+    task_ready.notify_all();
+    for (std::size_t i = 0; i < workers.size(); i++) {
+      workers[i].join();
+    }
+  }
+
+private:
+  void work() {
+    while (true) {
+      std::function <void()> task;
+      {
+        std::unique_lock <std::mutex> local_lock(master_lock);
+        while (!stopping && tasks.empty()) {
+          task_ready.wait(local_lock);
+        }
+        //(drain the queue even when stopping)
+        if (tasks.empty()) return;
+        task = std::move(tasks.front());
+        tasks.pop_front();
+      }
+      task();
+    }
+  }
+
+  std::vector <std::thread>            workers;
+  std::deque <std::function <void()>>  tasks;
+  bool                                 stopping;
+  std::mutex                           master_lock;
+  std::condition_variable              task_ready;
+};
+
+
+/*! Completion latch used by \ref parallel_copy_containers.*/
+class copy_tracker {
+public:
+  copy_tracker() : remaining(0) {}
+
+  void record(std::size_t count) {
+    std::lock_guard <std::mutex> local_lock(master_lock);
+    remaining += count;
+  }
+
+  void finish() {
+    std::lock_guard <std::mutex> local_lock(master_lock);
+    assert(remaining > 0);
+    if (!--remaining) all_finished.notify_all();
+  }
+
+  void wait() {
+    std::unique_lock <std::mutex> local_lock(master_lock);
+    while (remaining) {
+      all_finished.wait(local_lock);
+    }
+  }
+
+private:
+  copy_tracker(const copy_tracker&);
+  copy_tracker &operator = (const copy_tracker&);
+
+  std::size_t             remaining;
+  std::mutex              master_lock;
+  std::condition_variable all_finished;
+};
+
+
+/*! Type-erased (destination, source) pair used by \ref parallel_copy_containers.*/
+class copy_pair_base {
+public:
+  typedef lock_base::order_type order_type;
+
+  virtual order_type get_order_min() const = 0;
+  virtual order_type get_order_max() const = 0;
+  virtual bool acquire(lock_auth_base::auth_type &auth, meta_lock_base *master_lock, bool block) = 0;
+  virtual void release() = 0;
+  /*! Queue the copy itself, in at most 'chunks' tasks.*/
+  virtual void enqueue(thread_pool &pool, std::size_t chunks, copy_tracker &tracker) = 0;
+  virtual inline ~copy_pair_base() {}
+};
+
+typedef std::vector <std::unique_ptr <copy_pair_base>> copy_pair_set;
+
+
+/*! Helper class used by \ref parallel_copy_containers.*/
+template <class Type1, class Type2>
+class bound_copy_pair : public copy_pair_base {
+public:
+  bound_copy_pair(locking_container_base <Type1> &new_left,
+    locking_container_base <Type2> &new_right) : left(new_left), right(new_right) {}
+
+  order_type get_order_min() const {
+    return std::min(left.get_order(), right.get_order());
+  }
+
+  order_type get_order_max() const {
+    return std::max(left.get_order(), right.get_order());
+  }
+
+  bool acquire(lock_auth_base::auth_type &auth, meta_lock_base *master_lock, bool block) {
+    return get_two_locks(left, right, write, read, block, auth, master_lock);
+  }
+
+  void release() {
+    write.clear();
+    read.clear();
+  }
+
+  void enqueue(thread_pool &pool, std::size_t chunks, copy_tracker &tracker) {
+    this->enqueue_dispatch(pool, chunks, tracker,
+      std::integral_constant <bool, sizeof(Type1) >= chunk_threshold &&
+        std::is_same <Type1, Type2> ::value &&
+        std::is_trivially_copyable <Type1> ::value> ());
+  }
+
+private:
+  //(contiguous payloads at least a chunk in size are split across tasks)
+  static const std::size_t chunk_threshold = 1 << 16;
+
+  void enqueue_dispatch(thread_pool &pool, std::size_t /*chunks*/,
+    copy_tracker &tracker, std::false_type) {
+    tracker.record(1);
+    Type1       *to   = &*write;
+    const Type2 *from = &*read;
+    pool.execute([to, from, &tracker] {
+      *to = *from;
+      tracker.finish();
+    });
+  }
+
+  void enqueue_dispatch(thread_pool &pool, std::size_t chunks,
+    copy_tracker &tracker, std::true_type) {
+    if (chunks < 2) return this->enqueue_dispatch(pool, chunks, tracker, std::false_type());
+    char       *to   = (char*) (void*) &*write;
+    const char *from = (const char*) (const void*) &*read;
+    const std::size_t per_chunk = (sizeof(Type1) + chunks - 1) / chunks;
+    std::size_t queued = 0;
+    for (std::size_t start = 0; start < sizeof(Type1); start += per_chunk) ++queued;
+    tracker.record(queued);
+    for (std::size_t start = 0; start < sizeof(Type1); start += per_chunk) {
+      const std::size_t length = std::min(per_chunk, sizeof(Type1) - start);
+      pool.execute([to, from, start, length, &tracker] {
+        memcpy(to + start, from + start, length);
+        tracker.finish();
+      });
+    }
+  }
+
+  locking_container_base <Type1> &left;
+  locking_container_base <Type2> &right;
+  typename locking_container_base <Type1> ::write_proxy write;
+  typename locking_container_base <Type2> ::read_proxy  read;
+};
+
+
+/*! Add a (destination, source) pair to a \ref copy_pair_set.*/
+template <class Type1, class Type2>
+void add_copy_pair(copy_pair_set &pairs, locking_container_base <Type1> &left,
+  locking_container_base <Type2> &right) {
+  pairs.emplace_back(new bound_copy_pair <Type1, Type2> (left, right));
+}
+
+
+/*! \brief Copy a batch of containers concurrently.
+ *
+ * This is the batch counterpart of \ref try_copy_container: each pair's
+ * source payload is assigned to its destination, with the locking and the
+ * copying both parallelized. All pairs are locked up front (destination for
+ * writing, source for reading) and only then are the copies queued on the
+ * thread pool, so the batch is a consistent snapshot; the call returns once
+ * every copy has finished and all locks have been released.
+ *
+ * Acquisition follows \ref get_all_locks: each pair is locked with
+ * \ref get_two_locks, pairs with strictly-ascending non-zero lock orders
+ * (e.g., \ref ordered_lock containers) are taken in order and can block
+ * safely, and anything else blocks for at most one pair at a time while
+ * holding no others, backing off and retrying on conflict. Payloads of a
+ * single trivially-copyable type large enough to matter are additionally
+ * chunked across the pool's threads, so even one multi-gigabyte container
+ * copies at memory bandwidth rather than single-core speed.
+ *
+ * \attention A container must not appear as a destination in more than one
+ * pair, and a source in one pair must not be a destination in another.
+ *
+ * \param pairs pairs to copy (see \ref add_copy_pair)
+ * \param pool thread pool to execute the copies on
+ * \param block whether or not to block when locking the containers
+ * \param auth authorization object
+ * \param master_lock multi-lock tracking object
+ * \return success or failure, based entirely on locking success
+ */
+inline bool parallel_copy_containers(copy_pair_set &pairs, thread_pool &pool,
+  bool block = true, lock_auth_base::auth_type auth = lock_auth_base::auth_type(),
+  meta_lock_base *master_lock = NULL) {
+  if (pairs.empty()) return true;
+  for (std::size_t i = 0; i < pairs.size(); i++) {
+    pairs[i]->release();
+  }
+  //sort by lock order; stable, so that unordered (0) pairs keep call order
+  std::stable_sort(pairs.begin(), pairs.end(),
+    [](const std::unique_ptr <copy_pair_base> &left,
+       const std::unique_ptr <copy_pair_base> &right) {
+      return left->get_order_min() < right->get_order_min();
+    });
+  //with strictly-ascending non-zero orders, blocking in order can't deadlock
+  bool strictly_ordered = pairs[0]->get_order_min() > 0;
+  for (std::size_t i = 1; strictly_ordered && i < pairs.size(); i++) {
+    strictly_ordered = pairs[i - 1]->get_order_max() < pairs[i]->get_order_min();
+  }
+  bool acquired = false;
+  if (strictly_ordered) {
+    acquired = true;
+    for (std::size_t i = 0; i < pairs.size(); i++) {
+      if (!pairs[i]->acquire(auth, master_lock, block)) {
+        for (std::size_t j = 0; j < i; j++) pairs[j]->release();
+        acquired = false;
+        break;
+      }
+    }
+  } else {
+    //otherwise, only ever block while holding no other locks: wait for the
+    //most recently contended pair, then try-lock the rest, backing off
+    //(i.e., releasing everything) and re-waiting whenever a conflict shows up
+    std::size_t contended = 0;
+    while (true) {
+      if (!pairs[contended]->acquire(auth, master_lock, block)) break;
+      bool success = true;
+      for (std::size_t i = 0; success && i < pairs.size(); i++) {
+        if (i == contended) continue;
+        if (!pairs[i]->acquire(auth, master_lock, false)) {
+          success = false;
+          for (std::size_t j = 0; j <= i; j++) pairs[j]->release();
+          pairs[contended]->release();
+          if (!block) return false;
+          contended = i;
+        }
+      }
+      if (success) {
+        acquired = true;
+        break;
+      }
+      std::this_thread::yield();
+    }
+  }
+  if (!acquired) return false;
+  //everything is locked: run the copies concurrently, then release
+  copy_tracker tracker;
+  for (std::size_t i = 0; i < pairs.size(); i++) {
+    pairs[i]->enqueue(pool, pool.size(), tracker);
+  }
+  tracker.wait();
+  for (std::size_t i = 0; i < pairs.size(); i++) {
+    pairs[i]->release();
+  }
+  return true;
+}
+
+} //namespace lc
+
+#endif //lc_parallel_copy_hpp
@@ -0,0 +1,278 @@
+/* This software is released under the BSD License.
+ |
+ | Copyright (c) 2015, Kevin P. Barry [ta0kira@gmail.com]
+ | All rights reserved.
+ |
+ | Redistribution  and  use  in  source  and   binary  forms,  with  or  without
+ | modification, are permitted provided that the following conditions are met:
+ |
+ | - Redistributions of source code must retain the above copyright notice, this
+ |   list of conditions and the following disclaimer.
+ |
+ | - Redistributions in binary  form must reproduce the  above copyright notice,
+ |   this list  of conditions and the following disclaimer in  the documentation
+ |   and/or other materials provided with the distribution.
+ |
+ | - Neither the name  of the  Locking Container Project  nor  the names  of its
+ |   contributors may be  used to endorse or promote products  derived from this
+ |   software without specific prior written permission.
+ |
+ | THIS SOFTWARE IS  PROVIDED BY THE COPYRIGHT HOLDERS AND  CONTRIBUTORS "AS IS"
+ | AND ANY  EXPRESS OR IMPLIED  WARRANTIES,  INCLUDING, BUT  NOT LIMITED TO, THE
+ | IMPLIED WARRANTIES OF  MERCHANTABILITY  AND FITNESS FOR A  PARTICULAR PURPOSE
+ | ARE DISCLAIMED.  IN  NO EVENT SHALL  THE COPYRIGHT  OWNER  OR CONTRIBUTORS BE
+ | LIABLE  FOR  ANY  DIRECT,   INDIRECT,  INCIDENTAL,   SPECIAL,  EXEMPLARY,  OR
+ | CONSEQUENTIAL   DAMAGES  (INCLUDING,  BUT  NOT  LIMITED  TO,  PROCUREMENT  OF
+ | SUBSTITUTE GOODS OR SERVICES;  LOSS  OF USE,  DATA,  OR PROFITS;  OR BUSINESS
+ | INTERRUPTION)  HOWEVER  CAUSED  AND ON  ANY  THEORY OF LIABILITY,  WHETHER IN
+ | CONTRACT,  STRICT  LIABILITY, OR  TORT (INCLUDING  NEGLIGENCE  OR  OTHERWISE)
+ | ARISING IN ANY  WAY OUT OF  THE USE OF THIS SOFTWARE, EVEN  IF ADVISED OF THE
+ | POSSIBILITY OF SUCH DAMAGE.
+ +~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~*/
+
+/*! \file rcu-container.hpp
+ *  \brief Snapshot container with lock-free readers.
+ */
+
+#ifndef lc_rcu_container_hpp
+#define lc_rcu_container_hpp
+
+#include <memory>
+
+#include "locks.hpp"
+#include "lock-auth.hpp"
+
+namespace lc {
+
+
+/*! \class rcu_container
+ *  \brief Container with lock-free readers and copy-update-publish writers.
+ *
+ * The payload lives behind an atomically-swapped
+ * 'std::shared_ptr <const Type>'. \ref rcu_container::get_read returns a
+ * snapshot proxy with no lock at all: readers never block and never touch the
+ * writer's lock, but they may observe a payload that a writer has since
+ * replaced. \ref rcu_container::get_write serializes writers on a \ref w_lock
+ * (so the usual auth. machinery tracks the write side for deadlock
+ * prevention), copies the current payload into a working copy, and atomically
+ * publishes the copy when the proxy is cleared or destructed.
+ *
+ * This is intended for read-mostly data such as configuration or symbol
+ * tables; every write copies the whole payload.
+ */
+
+template <class Type>
+class rcu_container {
+public:
+  typedef Type                       type;
+  typedef lock_auth_base::auth_type  auth_type;
+
+  /*! Snapshot proxy for readers; shares ownership of the payload version it
+   *  observed, with no lock held.*/
+  class read_proxy;
+  /*! Move-only proxy for writers; publishes the working copy when cleared.*/
+  class write_proxy;
+
+  /*! \brief Constructor.*/
+  explicit rcu_container() : payload(new type) {}
+
+  /*! \brief Constructor.
+   *
+   * \param object object to copy as contained object.
+   */
+  explicit rcu_container(const type &object) : payload(new type(object)) {}
+
+private:
+  rcu_container(const rcu_container&);
+  rcu_container &operator = (const rcu_container&);
+
+public:
+  /** @name Accessor Functions
+   *
+   */
+  //@{
+
+  /*! \brief Retrieve a read-only snapshot of the contained object.
+   *
+   * This takes no lock and never fails. The snapshot remains valid (and keeps
+   * its payload version alive) for the proxy's lifetime, even if writers
+   * publish newer versions in the meantime.
+   *
+   * \return proxy object
+   */
+  read_proxy get_read() const {
+    return read_proxy(std::atomic_load(&payload));
+  }
+
+  /*! \brief Retrieve a writable proxy to a working copy of the contained
+   *  object.
+   *
+   * @see get_write_auth
+   * \param block Should the call block for a lock?
+   *
+   * \return proxy object
+   */
+  write_proxy get_write(bool block = true) {
+    return write_proxy(this, NULL, block);
+  }
+
+  /*! \brief Retrieve a writable proxy to a working copy of the contained
+   *  object using deadlock prevention.
+   *
+   * The returned proxy holds the container's write lock; modifications happen
+   * on a private copy and are atomically published when the proxy is cleared
+   * or destructed. Readers observe either the old or the new version, never a
+   * partial update.
+   *
+   * \param auth Authorization object to prevent deadlocks.
+   * \param block Should the call block for a lock?
+   *
+   * \return proxy object
+   */
+  write_proxy get_write_auth(auth_type &auth, bool block = true) {
+    if (!auth) return write_proxy();
+    return write_proxy(this, auth.get(), block);
+  }
+
+  //@}
+
+  /*! Get a new authorization object.*/
+  auth_type get_new_auth() const {
+    return rcu_container::new_auth();
+  }
+
+  /*! Get a new authorization object.*/
+  static auth_type new_auth() {
+    return auth_type(new lock_auth <w_lock>);
+  }
+
+private:
+  std::shared_ptr <const type> payload;
+  w_lock                       write_lock;
+};
+
+
+template <class Type>
+class rcu_container <Type> ::read_proxy {
+public:
+  read_proxy() {}
+
+  /*! \brief Clear the reference.
+   *
+   * \return *this
+   */
+  inline read_proxy &clear() {
+    snapshot.reset();
+    return *this;
+  }
+
+  inline operator bool() const     { return (bool) snapshot; }
+  inline bool operator ! () const  { return !snapshot; }
+
+  inline operator const Type*() const    { return snapshot.get(); }
+  inline const Type &operator *() const  { return *snapshot; }
+  inline const Type *operator ->() const { return snapshot.get(); }
+
+private:
+  friend class rcu_container;
+
+  explicit read_proxy(std::shared_ptr <const Type> new_snapshot) :
+    snapshot(new_snapshot) {}
+
+  std::shared_ptr <const Type> snapshot;
+};
+
+
+template <class Type>
+class rcu_container <Type> ::write_proxy {
+public:
+  write_proxy() : container(NULL), auth(NULL) {}
+
+  write_proxy(write_proxy &&other) : container(other.container),
+    working(other.working), auth(other.auth) {
+    other.forget();
+  }
+
+  write_proxy &operator = (write_proxy &&other) {
+    if (&other != this) {
+      this->opt_out();
+      container = other.container;
+      working   = other.working;
+      auth      = other.auth;
+      other.forget();
+    }
+    return *this;
+  }
+
+private:
+  write_proxy(const write_proxy&);
+  write_proxy &operator = (const write_proxy&);
+
+public:
+  /*! \brief Publish the working copy and unlock the container.
+   *
+   * \return *this
+   */
+  inline write_proxy &clear() {
+    this->opt_out();
+    return *this;
+  }
+
+  inline operator bool() const     { return (bool) working; }
+  inline bool operator ! () const  { return !working; }
+
+  inline operator       Type*()          { return  working.get(); }
+  inline operator const Type*() const    { return  working.get(); }
+  inline       Type &operator *()        { return *working; }
+  inline const Type &operator *() const  { return *working; }
+  inline       Type *operator ->()       { return  working.get(); }
+  inline const Type *operator ->() const { return  working.get(); }
+
+  inline ~write_proxy() {
+    this->opt_out();
+  }
+
+private:
+  friend class rcu_container;
+
+  write_proxy(rcu_container *new_container, lock_auth_base *new_auth, bool block) :
+    container(new_container), auth(new_auth) {
+    if (container->write_lock.lock(auth, false, block) < 0) {
+      this->forget();
+      return;
+    }
+    //(no other writer can swap the payload while the write lock is held)
+    try {
+      working.reset(new Type(*std::atomic_load(&container->payload)));
+    } catch (...) {
+      //NOTE: the destructor never runs if the copy throws here, so the write
+      //lock (and the auth.'s registration) must be released before rethrowing
+      container->write_lock.unlock(auth, false);
+      throw;
+    }
+  }
+
+  void opt_out() {
+    if (container && working) {
+      std::atomic_store(&container->payload,
+        std::shared_ptr <const Type> (working));
+      container->write_lock.unlock(auth, false);
+    }
+    this->forget();
+  }
+
+  //(clear the state without publishing or unlocking, e.g., after a move)
+  inline void forget() {
+    container = NULL;
+    auth      = NULL;
+    working.reset();
+  }
+
+  rcu_container         *container;
+  std::shared_ptr <Type> working;
+  lock_auth_base        *auth;
+};
+
+} //namespace lc
+
+#endif //lc_rcu_container_hpp
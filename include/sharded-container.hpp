@@ -0,0 +1,305 @@
+/* This software is released under the BSD License.
+ |
+ | Copyright (c) 2015, Kevin P. Barry [ta0kira@gmail.com]
+ | All rights reserved.
+ |
+ | Redistribution  and  use  in  source  and   binary  forms,  with  or  without
+ | modification, are permitted provided that the following conditions are met:
+ |
+ | - Redistributions of source code must retain the above copyright notice, this
+ |   list of conditions and the following disclaimer.
+ |
+ | - Redistributions in binary  form must reproduce the  above copyright notice,
+ |   this list  of conditions and the following disclaimer in  the documentation
+ |   and/or other materials provided with the distribution.
+ |
+ | - Neither the name  of the  Locking Container Project  nor  the names  of its
+ |   contributors may be  used to endorse or promote products  derived from this
+ |   software without specific prior written permission.
+ |
+ | THIS SOFTWARE IS  PROVIDED BY THE COPYRIGHT HOLDERS AND  CONTRIBUTORS "AS IS"
+ | AND ANY  EXPRESS OR IMPLIED  WARRANTIES,  INCLUDING, BUT  NOT LIMITED TO, THE
+ | IMPLIED WARRANTIES OF  MERCHANTABILITY  AND FITNESS FOR A  PARTICULAR PURPOSE
+ | ARE DISCLAIMED.  IN  NO EVENT SHALL  THE COPYRIGHT  OWNER  OR CONTRIBUTORS BE
+ | LIABLE  FOR  ANY  DIRECT,   INDIRECT,  INCIDENTAL,   SPECIAL,  EXEMPLARY,  OR
+ | CONSEQUENTIAL   DAMAGES  (INCLUDING,  BUT  NOT  LIMITED  TO,  PROCUREMENT  OF
+ | SUBSTITUTE GOODS OR SERVICES;  LOSS  OF USE,  DATA,  OR PROFITS;  OR BUSINESS
+ | INTERRUPTION)  HOWEVER  CAUSED  AND ON  ANY  THEORY OF LIABILITY,  WHETHER IN
+ | CONTRACT,  STRICT  LIABILITY, OR  TORT (INCLUDING  NEGLIGENCE  OR  OTHERWISE)
+ | ARISING IN ANY  WAY OUT OF  THE USE OF THIS SOFTWARE, EVEN  IF ADVISED OF THE
+ | POSSIBILITY OF SUCH DAMAGE.
+ +~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~*/
+
+/*! \file sharded-container.hpp
+ *  \brief Sharded map container with independently locked partitions.
+ */
+
+#ifndef lc_sharded_container_hpp
+#define lc_sharded_container_hpp
+
+#include <functional>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "locking-container.hpp"
+
+namespace lc {
+
+
+/*! \class sharded_locking_container
+ *  \brief Map-like container that partitions the keyspace across independently
+ *  locked shards.
+ *
+ * A single 'locking_container <std::unordered_map <Key, Value> >' serializes
+ * all writers on one lock. This container instead hashes each key onto one of
+ * 'Shards' shards, each of which is its own \ref locking_container; writers
+ * touching different shards never contend with each other.
+ *
+ * Each shard is protected by an \ref ordered_lock whose order is derived from
+ * the shard index, which gives full-sweep operations (iteration, rehash) a
+ * well-defined acquisition order. Because ordered locks reject locks without
+ * an auth. object, all access to this container requires one; use
+ * \ref sharded_locking_container::get_new_auth. If multiple sharded containers
+ * are used together, give them disjoint order ranges via 'base_order'.
+ */
+
+template <class Key, class Value, class Lock = rw_lock, unsigned int Shards = 16>
+class sharded_locking_container {
+  static_assert(Shards > 0, "sharded_locking_container requires at least one shard");
+
+public:
+  typedef Key                                          key_type;
+  typedef Value                                        value_type;
+  typedef std::unordered_map <key_type, value_type>    shard_type;
+  typedef locking_container <shard_type, ordered_lock <Lock> > shard_container;
+  typedef typename shard_container::write_proxy        shard_write_proxy;
+  typedef typename shard_container::read_proxy         shard_read_proxy;
+  typedef lock_auth_base::auth_type                    auth_type;
+  typedef lock_auth_base::order_type                   order_type;
+
+  /*! Proxy object referring to a single value, holding its shard's write lock.*/
+  class value_write_proxy;
+  /*! Proxy object referring to a single value, holding its shard's read lock.*/
+  class value_read_proxy;
+
+  /*! \brief Constructor.
+   *
+   * \param base_order order assigned to the first shard; shard i gets
+   * 'base_order + i'. Must be > 0 for order rules to apply.
+   */
+  explicit sharded_locking_container(order_type base_order = 1) {
+    for (unsigned int i = 0; i < Shards; i++) {
+      shards[i].reset(new shard_container(shard_type(), base_order + i));
+    }
+  }
+
+private:
+  sharded_locking_container(const sharded_locking_container&);
+  sharded_locking_container &operator = (const sharded_locking_container&);
+
+public:
+  /** @name Per-key Accessor Functions
+   *
+   */
+  //@{
+
+  /*! \brief Retrieve a writable proxy to the value stored for a key.
+   *
+   * The value is default-constructed if the key isn't present. The returned
+   * proxy holds a write lock on the key's entire shard.
+   *
+   * \param key key to look up
+   * \param auth Authorization object to prevent deadlocks.
+   * \param block Should the call block for a lock?
+   *
+   * \return proxy object
+   */
+  value_write_proxy get_write(const key_type &key, auth_type &auth, bool block = true) {
+    shard_write_proxy write = this->shard_for(key).get_write_auth(auth, block);
+    if (!write) return value_write_proxy();
+    return value_write_proxy(write, &(*write)[key]);
+  }
+
+  /*! \brief Retrieve a read-only proxy to the value stored for a key.
+   *
+   * If the key isn't present, the returned proxy is invalid and the shard is
+   * unlocked again. The returned proxy holds a read lock on the key's entire
+   * shard.
+   *
+   * \param key key to look up
+   * \param auth Authorization object to prevent deadlocks.
+   * \param block Should the call block for a lock?
+   *
+   * \return proxy object
+   */
+  value_read_proxy get_read(const key_type &key, auth_type &auth, bool block = true) {
+    shard_read_proxy read = this->shard_for(key).get_read_auth(auth, block);
+    if (!read) return value_read_proxy();
+    typename shard_type::const_iterator found = read->find(key);
+    if (found == read->end()) return value_read_proxy();
+    return value_read_proxy(read, &found->second);
+  }
+
+  /*! \brief Remove the value stored for a key.
+   *
+   * \param key key to remove
+   * \param auth Authorization object to prevent deadlocks.
+   * \param block Should the call block for a lock?
+   *
+   * \return whether a value was removed
+   */
+  bool erase(const key_type &key, auth_type &auth, bool block = true) {
+    shard_write_proxy write = this->shard_for(key).get_write_auth(auth, block);
+    if (!write) return false;
+    return write->erase(key) > 0;
+  }
+
+  //@}
+
+  /** @name Full-sweep Accessor Functions
+   *
+   */
+  //@{
+
+  /*! \brief Obtain write locks on all shards at once.
+   *
+   * Shards are locked in ascending order, using the order discipline of
+   * \ref ordered_lock; the auth. must therefore be an ordered auth. type
+   * (e.g., the one returned by \ref get_new_auth). On failure, all proxies
+   * obtained so far are released and the returned set is empty.
+   *
+   * \param auth Authorization object to prevent deadlocks.
+   * \param block Should the call block for a lock?
+   *
+   * \return proxies for all shards (empty on failure)
+   */
+  std::vector <shard_write_proxy> get_write_sweep(auth_type &auth, bool block = true) {
+    std::vector <shard_write_proxy> writes;
+    writes.reserve(Shards);
+    for (unsigned int i = 0; i < Shards; i++) {
+      shard_write_proxy write = shards[i]->get_write_auth(auth, block);
+      if (!write) return std::vector <shard_write_proxy> ();
+      writes.push_back(write);
+    }
+    return writes;
+  }
+
+  /*! \brief Obtain read locks on all shards at once.
+   *
+   * @see get_write_sweep
+   * \param auth Authorization object to prevent deadlocks.
+   * \param block Should the call block for a lock?
+   *
+   * \return proxies for all shards (empty on failure)
+   */
+  std::vector <shard_read_proxy> get_read_sweep(auth_type &auth, bool block = true) {
+    std::vector <shard_read_proxy> reads;
+    reads.reserve(Shards);
+    for (unsigned int i = 0; i < Shards; i++) {
+      shard_read_proxy read = shards[i]->get_read_auth(auth, block);
+      if (!read) return std::vector <shard_read_proxy> ();
+      reads.push_back(read);
+    }
+    return reads;
+  }
+
+  //@}
+
+  /*! Get a new authorization object suitable for the shard locks.*/
+  auth_type get_new_auth() const {
+    return shards[0]->get_new_auth();
+  }
+
+  /*! Get the number of shards.*/
+  static constexpr unsigned int shard_count() {
+    return Shards;
+  }
+
+  /*! Get the shard container holding a key, e.g., for use with
+   *  \ref try_copy_container.*/
+  shard_container &shard_for(const key_type &key) {
+    return *shards[std::hash <key_type> ()(key) % Shards];
+  }
+
+  /*! Get a shard container by index.*/
+  shard_container &shard_at(unsigned int index) {
+    return *shards[index % Shards];
+  }
+
+private:
+  std::unique_ptr <shard_container> shards[Shards];
+};
+
+
+template <class Key, class Value, class Lock, unsigned int Shards>
+class sharded_locking_container <Key, Value, Lock, Shards> ::value_write_proxy {
+public:
+  value_write_proxy() : value(NULL) {}
+
+  /*! \brief Clear the reference and unlock the shard.
+   *
+   * \return *this
+   */
+  inline value_write_proxy &clear() {
+    value = NULL;
+    shard.clear();
+    return *this;
+  }
+
+  inline operator bool() const     { return  value; }
+  inline bool operator ! () const  { return !value; }
+
+  inline operator       Value*()          { return  value; }
+  inline operator const Value*() const    { return  value; }
+  inline       Value &operator *()        { return *value; }
+  inline const Value &operator *() const  { return *value; }
+  inline       Value *operator ->()       { return  value; }
+  inline const Value *operator ->() const { return  value; }
+
+private:
+  friend class sharded_locking_container;
+
+  value_write_proxy(shard_write_proxy new_shard, Value *new_value) :
+    shard(new_shard), value(new_value) {}
+
+  shard_write_proxy  shard;
+  Value             *value;
+};
+
+
+template <class Key, class Value, class Lock, unsigned int Shards>
+class sharded_locking_container <Key, Value, Lock, Shards> ::value_read_proxy {
+public:
+  value_read_proxy() : value(NULL) {}
+
+  /*! \brief Clear the reference and unlock the shard.
+   *
+   * \return *this
+   */
+  inline value_read_proxy &clear() {
+    value = NULL;
+    shard.clear();
+    return *this;
+  }
+
+  inline operator bool() const     { return  value; }
+  inline bool operator ! () const  { return !value; }
+
+  inline operator const Value*() const    { return  value; }
+  inline const Value &operator *() const  { return *value; }
+  inline const Value *operator ->() const { return  value; }
+
+private:
+  friend class sharded_locking_container;
+
+  value_read_proxy(shard_read_proxy new_shard, const Value *new_value) :
+    shard(new_shard), value(new_value) {}
+
+  shard_read_proxy  shard;
+  const Value      *value;
+};
+
+} //namespace lc
+
+#endif //lc_sharded_container_hpp
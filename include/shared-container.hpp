@@ -0,0 +1,405 @@
+/* This software is released under the BSD License.
+ |
+ | Copyright (c) 2015, Kevin P. Barry [ta0kira@gmail.com]
+ | All rights reserved.
+ |
+ | Redistribution  and  use  in  source  and   binary  forms,  with  or  without
+ | modification, are permitted provided that the following conditions are met:
+ |
+ | - Redistributions of source code must retain the above copyright notice, this
+ |   list of conditions and the following disclaimer.
+ |
+ | - Redistributions in binary  form must reproduce the  above copyright notice,
+ |   this list  of conditions and the following disclaimer in  the documentation
+ |   and/or other materials provided with the distribution.
+ |
+ | - Neither the name  of the  Locking Container Project  nor  the names  of its
+ |   contributors may be  used to endorse or promote products  derived from this
+ |   software without specific prior written permission.
+ |
+ | THIS SOFTWARE IS  PROVIDED BY THE COPYRIGHT HOLDERS AND  CONTRIBUTORS "AS IS"
+ | AND ANY  EXPRESS OR IMPLIED  WARRANTIES,  INCLUDING, BUT  NOT LIMITED TO, THE
+ | IMPLIED WARRANTIES OF  MERCHANTABILITY  AND FITNESS FOR A  PARTICULAR PURPOSE
+ | ARE DISCLAIMED.  IN  NO EVENT SHALL  THE COPYRIGHT  OWNER  OR CONTRIBUTORS BE
+ | LIABLE  FOR  ANY  DIRECT,   INDIRECT,  INCIDENTAL,   SPECIAL,  EXEMPLARY,  OR
+ | CONSEQUENTIAL   DAMAGES  (INCLUDING,  BUT  NOT  LIMITED  TO,  PROCUREMENT  OF
+ | SUBSTITUTE GOODS OR SERVICES;  LOSS  OF USE,  DATA,  OR PROFITS;  OR BUSINESS
+ | INTERRUPTION)  HOWEVER  CAUSED  AND ON  ANY  THEORY OF LIABILITY,  WHETHER IN
+ | CONTRACT,  STRICT  LIABILITY, OR  TORT (INCLUDING  NEGLIGENCE  OR  OTHERWISE)
+ | ARISING IN ANY  WAY OUT OF  THE USE OF THIS SOFTWARE, EVEN  IF ADVISED OF THE
+ | POSSIBILITY OF SUCH DAMAGE.
+ +~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~*/
+
+#ifndef lc_shared_container_hpp
+#define lc_shared_container_hpp
+
+#include <new>
+
+#include <errno.h>
+#include <pthread.h>
+
+#include "locking-container.hpp"
+
+//NOTE: unlike the other lock types, everything here is defined inline in this
+//header (rather than in locking-container.inc) so that the core headers stay
+//free of the POSIX dependency unless cross-process support is actually used
+
+namespace lc {
+
+
+/*! \class shared_lock_state
+ *  \brief Process-shared lock state for \ref shared_rw_lock.
+ *
+ * This struct holds the portion of a read/write lock that must live in a
+ * shared-memory segment: process-shared pthread primitives plus the
+ * reader/writer counters. It contains no pointers and no virtual table, so its
+ * bytes are valid in every process that maps the segment, regardless of where
+ * the mapping lands. Exactly one process calls \ref initialize before any use
+ * and \ref destroy after all use; every process then wraps the state in its
+ * own (process-local) \ref shared_rw_lock view.
+ *
+ * The mutex is created robust: if a process dies while actually holding the
+ * mutex (i.e., mid-update of the counters), the next locker marks it
+ * consistent and continues, since the counters are only modified in short
+ * critical sections that leave them valid. A process that dies while holding
+ * a read or write lock on the container is a different matter: its claim on
+ * the counters can't be distinguished from a live one, so the lock appears
+ * held forever. \ref recover resets the counters for that case, but it's only
+ * safe to call when the caller knows that no live process holds a lock.
+ */
+
+struct shared_lock_state {
+  /*! \brief Initialize the lock state in place. Returns 0, or an errno value
+   *  on failure.
+   */
+  inline int initialize() {
+    readers = readers_waiting = 0;
+    writer  = writer_waiting  = false;
+    int error = 0;
+    pthread_mutexattr_t mutex_attr;
+    if ((error = pthread_mutexattr_init(&mutex_attr)) != 0) return error;
+    pthread_mutexattr_setpshared(&mutex_attr, PTHREAD_PROCESS_SHARED);
+    pthread_mutexattr_setrobust(&mutex_attr, PTHREAD_MUTEX_ROBUST);
+    error = pthread_mutex_init(&master_lock, &mutex_attr);
+    pthread_mutexattr_destroy(&mutex_attr);
+    if (error != 0) return error;
+    pthread_condattr_t cond_attr;
+    if ((error = pthread_condattr_init(&cond_attr)) != 0) {
+      pthread_mutex_destroy(&master_lock);
+      return error;
+    }
+    pthread_condattr_setpshared(&cond_attr, PTHREAD_PROCESS_SHARED);
+    if ((error = pthread_cond_init(&read_wait, &cond_attr)) != 0) {
+      pthread_condattr_destroy(&cond_attr);
+      pthread_mutex_destroy(&master_lock);
+      return error;
+    }
+    if ((error = pthread_cond_init(&write_wait, &cond_attr)) != 0) {
+      pthread_condattr_destroy(&cond_attr);
+      pthread_cond_destroy(&read_wait);
+      pthread_mutex_destroy(&master_lock);
+      return error;
+    }
+    pthread_condattr_destroy(&cond_attr);
+    return 0;
+  }
+
+  /*! Destroy the lock state. No process may use it afterward.*/
+  inline void destroy() {
+    pthread_cond_destroy(&write_wait);
+    pthread_cond_destroy(&read_wait);
+    pthread_mutex_destroy(&master_lock);
+  }
+
+  /*! \brief Discard lock claims left behind by dead processes.
+   *
+   * \attention Only call this when no live process holds (or is waiting for)
+   * a lock; otherwise a live holder's lock is silently revoked.
+   */
+  inline void recover() {
+    readers = readers_waiting = 0;
+    writer  = writer_waiting  = false;
+  }
+
+  pthread_mutex_t master_lock;
+  pthread_cond_t  read_wait, write_wait;
+
+  long readers, readers_waiting;
+  bool writer, writer_waiting;
+};
+
+
+/*! \class shared_rw_lock
+ *  \brief Process-shared read/write lock.
+ *
+ * This is a per-process view over a \ref shared_lock_state: the view itself
+ * (with its virtual table) lives in ordinary process memory, so virtual
+ * dispatch through \ref lock_base works in every process, while all of the
+ * actual lock state lives in the mapped segment. Construct one view per
+ * process over the same state and the usual proxy/auth. API works across the
+ * process boundary.
+ *
+ * Semantics match \ref rw_lock, with three omissions: there is no writer-reads
+ * exception (authorization objects are process-local, so two processes could
+ * hold auth. objects at the same address and spuriously match), no
+ * \ref lock_base::upgrade, and no \ref lock_base::wait_for_update. Timed
+ * accessors fall back to a non-blocking attempt (the \ref lock_base default).
+ */
+
+class shared_rw_lock : public lock_base {
+public:
+  using lock_base::count_type;
+
+  explicit shared_rw_lock(shared_lock_state &new_state) : state(new_state) {}
+
+private:
+  shared_rw_lock(const shared_rw_lock&);
+  shared_rw_lock &operator = (const shared_rw_lock&);
+
+public:
+  count_type lock(lock_auth_base *auth, bool read, bool block = true, bool test = false) {
+    if (this->lock_master() != 0) return -1;
+    bool lock_out   = state.writer_waiting || state.readers_waiting;
+    bool must_block = state.writer_waiting ||
+      (read? state.writer : (state.readers || state.writer));
+    lock_data l(this, block, read, lock_out, must_block, this->get_order());
+    //make sure this is an authorized lock type for the caller
+    if (!register_or_test_auth(auth, l, test)) {
+      pthread_mutex_unlock(&state.master_lock);
+      return -1;
+    }
+    block = l.block; //(auth. can override blocking mode to allow lock attempt)
+    if (!block && must_block) {
+      if (!test) release_auth(auth, l);
+      pthread_mutex_unlock(&state.master_lock);
+      return -1;
+    }
+    if (read) {
+      //get a read lock
+      ++state.readers_waiting;
+      assert(state.readers_waiting > 0);
+      while (state.writer || state.writer_waiting) {
+        if (this->wait_master(&state.read_wait) != 0) {
+          --state.readers_waiting;
+          if (!test) release_auth(auth, l);
+          pthread_mutex_unlock(&state.master_lock);
+          return -1;
+        }
+      }
+      --state.readers_waiting;
+      count_type new_readers = (count_type) ++state.readers;
+      assert(!state.writer && state.readers > 0);
+      pthread_mutex_unlock(&state.master_lock);
+      return new_readers;
+    } else {
+      //if the caller isn't the first in line for writing, wait until it is
+      ++state.readers_waiting;
+      assert(state.readers_waiting > 0);
+      while (state.writer_waiting) {
+        //NOTE: use 'read_wait' here, since that's what a write unlock broadcasts on
+        if (this->wait_master(&state.read_wait) != 0) {
+          --state.readers_waiting;
+          if (!test) release_auth(auth, l);
+          pthread_mutex_unlock(&state.master_lock);
+          return -1;
+        }
+      }
+      --state.readers_waiting;
+      state.writer_waiting = true;
+      //get a write lock
+      while (state.writer || state.readers) {
+        if (this->wait_master(&state.write_wait) != 0) {
+          state.writer_waiting = false;
+          //(anything waiting behind the aborted writer can now proceed)
+          if (state.readers_waiting) pthread_cond_broadcast(&state.read_wait);
+          if (!test) release_auth(auth, l);
+          pthread_mutex_unlock(&state.master_lock);
+          return -1;
+        }
+      }
+      state.writer_waiting = false;
+      state.writer = true;
+      pthread_mutex_unlock(&state.master_lock);
+      return 0;
+    }
+  }
+
+  count_type unlock(lock_auth_base *auth, bool read, bool test = false) {
+    if (this->lock_master() != 0) return -1;
+    if (!test) {
+      unlock_data l(this, read, this->get_order());
+      release_auth(auth, l);
+    }
+    if (read) {
+      assert(!state.writer && state.readers > 0);
+      count_type new_readers = (count_type) --state.readers;
+      if (!new_readers && state.writer_waiting) {
+        pthread_cond_broadcast(&state.write_wait);
+      }
+      pthread_mutex_unlock(&state.master_lock);
+      return new_readers;
+    } else {
+      assert(state.writer && !state.readers);
+      state.writer = false;
+      if (state.readers_waiting) pthread_cond_broadcast(&state.read_wait);
+      if (state.writer_waiting)  pthread_cond_broadcast(&state.write_wait);
+      pthread_mutex_unlock(&state.master_lock);
+      return 0;
+    }
+  }
+
+private:
+  //(on EOWNERDEAD the previous owner died mid-update of the counters; mark
+  //the mutex consistent and continue — the critical sections here never leave
+  //the counters in an invalid state)
+  inline int lock_master() {
+    int error = pthread_mutex_lock(&state.master_lock);
+    if (error == EOWNERDEAD) {
+      pthread_mutex_consistent(&state.master_lock);
+      error = 0;
+    }
+    return error;
+  }
+
+  inline int wait_master(pthread_cond_t *cond) {
+    int error = pthread_cond_wait(cond, &state.master_lock);
+    if (error == EOWNERDEAD) {
+      pthread_mutex_consistent(&state.master_lock);
+      error = 0;
+    }
+    return error;
+  }
+
+  shared_lock_state &state;
+};
+
+
+/*! \class lock_auth <shared_rw_lock>
+ *  \brief Authorization class for \ref shared_rw_lock.
+ *
+ * Authorization objects are per-process; they track the holding thread's own
+ * locks, which is all that deadlock prevention needs. The safe combinations
+ * are those of \ref rw_lock, minus the writer-reads exception (which
+ * \ref shared_rw_lock doesn't grant).
+ */
+
+template <>
+class lock_auth <shared_rw_lock> : public lock_auth_rw_lock {};
+
+
+/*! \class shared_container_state
+ *  \brief Shared-memory image of a \ref shared_container.
+ *
+ * This struct is what actually lives in the mapped segment: the contained
+ * object followed by the lock state. The contained type must be trivially
+ * copyable so that its bytes mean the same thing in every process (no
+ * pointers into one process's heap, no virtual table).
+ */
+
+template <class Type>
+struct shared_container_state {
+  static_assert(std::is_trivially_copyable <Type> ::value,
+    "shared_container_state requires a trivially-copyable type");
+
+  /*! \brief Placement-construct a container state in mapped memory.
+   *
+   * Exactly one process calls this, before any other process touches the
+   * segment; the others just cast the mapped base address. Returns NULL if
+   * the lock state can't be initialized.
+   *
+   * \param where segment address to construct at (suitably aligned)
+   * \param initial initial value for the contained object
+   *
+   * \return pointer to the constructed state, or NULL
+   */
+  static shared_container_state *create_at(void *where, const Type &initial = Type()) {
+    shared_container_state *state = new(where) shared_container_state;
+    state->value = initial;
+    if (state->lock_state.initialize() != 0) return NULL;
+    return state;
+  }
+
+  Type              value;
+  shared_lock_state lock_state;
+};
+
+
+/*! \class shared_container
+ *  \brief \ref locking_container variant for shared-memory segments.
+ *
+ * This is a per-process view over a \ref shared_container_state: producer and
+ * consumer processes map the same segment, one of them calls
+ * \ref shared_container_state::create_at, and each process constructs its own
+ * view over the result. Proxies obtained from the view then read and write
+ * the object in place in the segment — zero-copy cross-process handoff under
+ * the same proxy/auth. API as any other container.
+ *
+ * \attention Multi-locking (\ref locking_container_base::get_write_multi,
+ * etc.) is not supported: a \ref meta_lock is process-local, so it can't
+ * coordinate lock sets across processes. Those accessors return empty
+ * proxies. Timed accessors fall back to a non-blocking attempt.
+ */
+
+template <class Type>
+class shared_container : public locking_container_base <Type> {
+private:
+  typedef lock_auth <shared_rw_lock> auth_base_type;
+
+public:
+  typedef locking_container_base <Type> base;
+  using typename base::type;
+  using typename base::write_proxy;
+  using typename base::read_proxy;
+  using typename base::auth_type;
+  //NOTE: this is needed so that the 'lock_auth_base' variants are pulled in
+  using base::get_write_auth;
+  using base::get_read_auth;
+
+  typedef shared_container_state <Type> state_type;
+
+  /*! \brief Constructor.
+   *
+   * \param new_state container state in the mapped segment.
+   */
+  explicit shared_container(state_type &new_state) :
+    state(new_state), locks(new_state.lock_state) {}
+
+private:
+  shared_container(const shared_container&);
+  shared_container &operator = (const shared_container&);
+
+public:
+  /** @name Authorization
+   *
+   */
+  //@{
+
+  /*! Get a new authorization object.*/
+  auth_type get_new_auth() const {
+    return shared_container::new_auth();
+  }
+
+  /*! Get a new authorization object.*/
+  static auth_type new_auth() {
+    return auth_type(new auth_base_type);
+  }
+
+  //@}
+
+  //(the non-owning fast-path overloads; see locking_container_base)
+  inline write_proxy get_write_auth(lock_auth_base *auth, bool block) {
+    return write_proxy(&state.value, &locks, auth, false, block, NULL);
+  }
+
+  inline read_proxy get_read_auth(lock_auth_base *auth, bool block) {
+    return read_proxy(&state.value, &locks, auth, true, block, NULL);
+  }
+
+private:
+  state_type    &state;
+  shared_rw_lock locks;
+};
+
+} //namespace lc
+
+#endif //lc_shared_container_hpp
@@ -0,0 +1,268 @@
+/* This software is released under the BSD License.
+ |
+ | Copyright (c) 2015, Kevin P. Barry [ta0kira@gmail.com]
+ | All rights reserved.
+ |
+ | Redistribution  and  use  in  source  and   binary  forms,  with  or  without
+ | modification, are permitted provided that the following conditions are met:
+ |
+ | - Redistributions of source code must retain the above copyright notice, this
+ |   list of conditions and the following disclaimer.
+ |
+ | - Redistributions in binary  form must reproduce the  above copyright notice,
+ |   this list  of conditions and the following disclaimer in  the documentation
+ |   and/or other materials provided with the distribution.
+ |
+ | - Neither the name  of the  Locking Container Project  nor  the names  of its
+ |   contributors may be  used to endorse or promote products  derived from this
+ |   software without specific prior written permission.
+ |
+ | THIS SOFTWARE IS  PROVIDED BY THE COPYRIGHT HOLDERS AND  CONTRIBUTORS "AS IS"
+ | AND ANY  EXPRESS OR IMPLIED  WARRANTIES,  INCLUDING, BUT  NOT LIMITED TO, THE
+ | IMPLIED WARRANTIES OF  MERCHANTABILITY  AND FITNESS FOR A  PARTICULAR PURPOSE
+ | ARE DISCLAIMED.  IN  NO EVENT SHALL  THE COPYRIGHT  OWNER  OR CONTRIBUTORS BE
+ | LIABLE  FOR  ANY  DIRECT,   INDIRECT,  INCIDENTAL,   SPECIAL,  EXEMPLARY,  OR
+ | CONSEQUENTIAL   DAMAGES  (INCLUDING,  BUT  NOT  LIMITED  TO,  PROCUREMENT  OF
+ | SUBSTITUTE GOODS OR SERVICES;  LOSS  OF USE,  DATA,  OR PROFITS;  OR BUSINESS
+ | INTERRUPTION)  HOWEVER  CAUSED  AND ON  ANY  THEORY OF LIABILITY,  WHETHER IN
+ | CONTRACT,  STRICT  LIABILITY, OR  TORT (INCLUDING  NEGLIGENCE  OR  OTHERWISE)
+ | ARISING IN ANY  WAY OUT OF  THE USE OF THIS SOFTWARE, EVEN  IF ADVISED OF THE
+ | POSSIBILITY OF SUCH DAMAGE.
+ +~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~*/
+
+/* This is a micro-benchmark of lock acquisition, complementing the correctness
+ * matrix in unit.cpp. One invocation measures one scenario (see 'bench.sh' for
+ * the sweep) and prints a single machine-readable line of key=value pairs:
+ * total acquisitions per second, plus p50/p99 acquisition latency sampled on
+ * every 8th operation. Run one release against another and diff the output.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "locking-container.hpp"
+//(necessary for non-template source)
+#include "locking-container.inc"
+
+#define SUCCESS    0
+#define ERROR_ARGS 1
+#define ERROR_LOCK 2
+
+
+//typedefs
+
+typedef lc::locking_container_base <long>     protected_value;
+typedef std::shared_ptr <protected_value>     container_pointer;
+typedef protected_value::write_proxy          write_proxy;
+typedef protected_value::read_proxy           read_proxy;
+typedef protected_value::auth_type            auth_type;
+typedef std::chrono::steady_clock             clock_type;
+
+
+//scenario dimensions (keep the numbering in sync with 'bench.sh')
+
+enum workload_select {
+  workload_uncontended = 0, //(meant to be run with one thread)
+  workload_read_heavy  = 1, //(19 reads per write)
+  workload_write_heavy = 2, //(writes only)
+  workload_mixed       = 3, //(1 read per write)
+  workload_proxy       = 4, //(proxy copy/clear on a held lock; one thread)
+};
+
+enum lock_select {
+  lock_rw_lock      = 0,
+  lock_w_lock       = 1,
+  lock_dumb_lock    = 2,
+  lock_ordered_lock = 3,
+};
+
+enum path_select {
+  path_plain = 0,
+  path_auth  = 1,
+  path_multi = 2,
+};
+
+static const char *workload_names[] =
+  { "uncontended", "read_heavy", "write_heavy", "mixed", "proxy" };
+static const char *lock_names[] =
+  { "rw_lock", "w_lock", "dumb_lock", "ordered_lock" };
+static const char *path_names[] =
+  { "plain", "auth", "multi" };
+
+//(latency is sampled on every Nth acquisition so that timing doesn't dominate)
+static const int sample_every = 8;
+
+
+static container_pointer create_container(int lock_type) {
+  switch (lock_type) {
+    case lock_rw_lock:
+      return container_pointer(new lc::locking_container <long, lc::rw_lock> (0));
+    case lock_w_lock:
+      return container_pointer(new lc::locking_container <long, lc::w_lock> (0));
+    case lock_dumb_lock:
+      return container_pointer(new lc::locking_container <long, lc::dumb_lock> (0));
+    case lock_ordered_lock:
+      return container_pointer(new lc::locking_container <long,
+        lc::ordered_lock <lc::rw_lock> > (0, 1));
+    default:
+      return container_pointer();
+  }
+}
+
+
+struct worker_result {
+  worker_result() : operations(0), failures(0) {}
+  long                 operations, failures;
+  std::vector <long>   samples_ns; //(latency of sampled acquisitions)
+};
+
+
+static void run_worker(protected_value &container, lc::meta_lock &master,
+  int workload, int path, long operations, std::atomic <int> &start_barrier,
+  worker_result &result) {
+  auth_type auth(container.get_new_auth());
+  result.samples_ns.reserve(operations / sample_every + 1);
+
+  //(simple spin barrier so all threads start measuring together)
+  --start_barrier;
+  while (start_barrier.load() > 0) std::this_thread::yield();
+
+  for (long n = 0; n < operations; n++) {
+    bool write = true;
+    switch (workload) {
+      case workload_read_heavy: write = (n % 20 == 0); break;
+      case workload_mixed:      write = (n % 2 == 0);  break;
+      default:                  break;
+    }
+    const bool sample = (n % sample_every == 0);
+    clock_type::time_point before;
+    if (sample) before = clock_type::now();
+    bool success = false;
+    if (write) {
+      write_proxy proxy;
+      switch (path) {
+        case path_plain: proxy = container.get_write();                    break;
+        case path_auth:  proxy = container.get_write_auth(auth);           break;
+        case path_multi: proxy = container.get_write_multi(master, auth);  break;
+      }
+      success = proxy;
+      if (sample && success) {
+        result.samples_ns.push_back(std::chrono::duration_cast
+          <std::chrono::nanoseconds> (clock_type::now() - before).count());
+      }
+      if (success) ++*proxy;
+    } else {
+      read_proxy proxy;
+      switch (path) {
+        case path_plain: proxy = container.get_read();                   break;
+        case path_auth:  proxy = container.get_read_auth(auth);          break;
+        case path_multi: proxy = container.get_read_multi(master, auth); break;
+      }
+      success = proxy;
+      if (sample && success) {
+        result.samples_ns.push_back(std::chrono::duration_cast
+          <std::chrono::nanoseconds> (clock_type::now() - before).count());
+      }
+    }
+    if (success) ++result.operations;
+    else         ++result.failures;
+  }
+}
+
+
+//(proxy copy/clear cost: the lock is only taken once; the loop measures the
+//reference-counted copy and the drop of a non-final reference)
+static void run_proxy_workload(protected_value &container, long operations,
+  worker_result &result) {
+  write_proxy held = container.get_write();
+  if (!held) return;
+  result.samples_ns.reserve(operations / sample_every + 1);
+  for (long n = 0; n < operations; n++) {
+    const bool sample = (n % sample_every == 0);
+    clock_type::time_point before;
+    if (sample) before = clock_type::now();
+    write_proxy copy = held;
+    copy.clear();
+    if (sample) {
+      result.samples_ns.push_back(std::chrono::duration_cast
+        <std::chrono::nanoseconds> (clock_type::now() - before).count());
+    }
+    ++result.operations;
+  }
+}
+
+
+static long percentile(std::vector <long> &samples, double fraction) {
+  if (samples.empty()) return 0;
+  size_t index = (size_t) (fraction * (samples.size() - 1));
+  std::nth_element(samples.begin(), samples.begin() + index, samples.end());
+  return samples[index];
+}
+
+
+int main(int argc, char *argv[]) {
+  if (argc != 5 && argc != 6) {
+    fprintf(stderr, "%s [threads] [workload] [lock type] [path] (ops per thread)\n", argv[0]);
+    fprintf(stderr, "workloads:  0 uncontended, 1 read-heavy, 2 write-heavy, 3 mixed, 4 proxy\n");
+    fprintf(stderr, "lock types: 0 rw_lock, 1 w_lock, 2 dumb_lock, 3 ordered_lock <rw_lock>\n");
+    fprintf(stderr, "paths:      0 plain, 1 auth, 2 multi\n");
+    return ERROR_ARGS;
+  }
+
+  int  threads    = atoi(argv[1]);
+  int  workload   = atoi(argv[2]);
+  int  lock_type  = atoi(argv[3]);
+  int  path       = atoi(argv[4]);
+  long operations = (argc == 6)? atol(argv[5]) : 100000;
+
+  if (threads < 1 || workload < 0 || workload > 4 || lock_type < 0 ||
+    lock_type > 3 || path < 0 || path > 2 || operations < 1) return ERROR_ARGS;
+  //(single-thread-only workloads)
+  if (workload == workload_uncontended || workload == workload_proxy) threads = 1;
+
+  container_pointer container = create_container(lock_type);
+  if (!container) return ERROR_ARGS;
+  lc::meta_lock master;
+
+  std::vector <worker_result> results(threads);
+  std::atomic <int> start_barrier(threads);
+
+  clock_type::time_point start = clock_type::now();
+  if (workload == workload_proxy) {
+    run_proxy_workload(*container, operations, results[0]);
+  } else {
+    std::vector <std::thread> workers;
+    for (int t = 0; t < threads; t++) {
+      workers.emplace_back(run_worker, std::ref(*container), std::ref(master),
+        workload, path, operations, std::ref(start_barrier), std::ref(results[t]));
+    }
+    for (int t = 0; t < threads; t++) workers[t].join();
+  }
+  double seconds = std::chrono::duration_cast <std::chrono::duration <double> > (
+    clock_type::now() - start).count();
+
+  long total_operations = 0, total_failures = 0;
+  std::vector <long> samples;
+  for (int t = 0; t < threads; t++) {
+    total_operations += results[t].operations;
+    total_failures   += results[t].failures;
+    samples.insert(samples.end(), results[t].samples_ns.begin(),
+      results[t].samples_ns.end());
+  }
+  //(a scenario where locking failed outright isn't worth reporting)
+  if (!total_operations) return ERROR_LOCK;
+
+  printf("threads=%d workload=%s lock=%s path=%s ops=%ld failures=%ld "
+    "seconds=%.6f ops_per_sec=%.0f p50_ns=%ld p99_ns=%ld\n",
+    threads, workload_names[workload], lock_names[lock_type], path_names[path],
+    total_operations, total_failures, seconds, total_operations / seconds,
+    percentile(samples, 0.50), percentile(samples, 0.99));
+  return SUCCESS;
+}
@@ -0,0 +1,46 @@
+#!/usr/bin/env bash
+
+#sweeps the benchmark scenarios in bench.cpp and prints one machine-readable
+#line per scenario (comment lines start with '#'). redirect to a file and diff
+#against a previous release. optional first argument overrides the number of
+#operations per thread (default 100000).
+
+comp='c++ -Wall -pedantic -std=c++11 -g -O2 -I../include bench.cpp -o bench -lpthread'
+prog='./bench'
+threads='1 2 4 8'
+workloads='0 1 2 3 4'
+locks='0 1 2 3'
+paths='0 1 2'
+ops=${1:-100000}
+
+valid_scenario() {
+  local t=$1
+  local w=$2
+  local l=$3
+  local p=$4
+  #single-thread-only workloads: run once, not per thread count
+  { [ "$w" -eq 0 ] || [ "$w" -eq 4 ]; } && [ "$t" -ne 1 ] && return 1
+  #proxy copy/clear doesn't exercise the acquisition paths
+  [ "$w" -eq 4 ] && [ "$p" -ne 0 ] && return 1
+  #ordered locks require an ordered auth.
+  [ "$l" -eq 3 ] && [ "$p" -eq 0 ] && return 1
+  return 0
+}
+
+cd "$(dirname "$0")" || exit 1
+
+echo "# $comp"
+eval $comp || exit 1
+
+echo "# ops_per_thread=$ops"
+
+for w in $workloads; do
+  for l in $locks; do
+    for p in $paths; do
+      for t in $threads; do
+        valid_scenario "$t" "$w" "$l" "$p" || continue
+        $prog "$t" "$w" "$l" "$p" "$ops" || echo "# FAILED: $prog $t $w $l $p $ops [exit: $?]"
+      done
+    done
+  done
+done
@@ -0,0 +1,36 @@
+#!/usr/bin/env bash
+
+#builds and runs the header compile-plus-smoke test in headers.cpp, once as
+#C++11 and once as C++20 with coroutines enabled so async-container.hpp is
+#covered. the C++20 pass is skipped (not failed) if the compiler can't build
+#it, since the core library only requires C++11.
+
+comp='c++ -Wall -pedantic -std=c++11 -g -O2 -I../include headers.cpp -o headers -lpthread'
+comp_async='c++ -Wall -pedantic -std=c++20 -DLC_ENABLE_COROUTINES -g -O2 -I../include headers.cpp -o headers-async -lpthread'
+prog='./headers'
+prog_async='./headers-async'
+
+run_pass() {
+  echo "// $2 //"
+  "$1"
+  local result=$?
+  if [ "$result" -eq 0 ]; then
+    echo "PASSED [exit: $result]"
+  else
+    echo "FAILED [exit: $result]"
+    exit 1
+  fi
+}
+
+cd "$(dirname "$0")" || exit 1
+
+echo "// $comp //"
+eval $comp || exit 1
+run_pass "$prog" "$prog"
+
+echo "// $comp_async //"
+if eval $comp_async; then
+  run_pass "$prog_async" "$prog_async"
+else
+  echo "SKIPPED [no C++20 coroutine support]"
+fi
@@ -0,0 +1,284 @@
+/* This software is released under the BSD License.
+ |
+ | Copyright (c) 2015, Kevin P. Barry [ta0kira@gmail.com]
+ | All rights reserved.
+ |
+ | Redistribution  and  use  in  source  and   binary  forms,  with  or  without
+ | modification, are permitted provided that the following conditions are met:
+ |
+ | - Redistributions of source code must retain the above copyright notice, this
+ |   list of conditions and the following disclaimer.
+ |
+ | - Redistributions in binary  form must reproduce the  above copyright notice,
+ |   this list  of conditions and the following disclaimer in  the documentation
+ |   and/or other materials provided with the distribution.
+ |
+ | - Neither the name  of the  Locking Container Project  nor  the names  of its
+ |   contributors may be  used to endorse or promote products  derived from this
+ |   software without specific prior written permission.
+ |
+ | THIS SOFTWARE IS  PROVIDED BY THE COPYRIGHT HOLDERS AND  CONTRIBUTORS "AS IS"
+ | AND ANY  EXPRESS OR IMPLIED  WARRANTIES,  INCLUDING, BUT  NOT LIMITED TO, THE
+ | IMPLIED WARRANTIES OF  MERCHANTABILITY  AND FITNESS FOR A  PARTICULAR PURPOSE
+ | ARE DISCLAIMED.  IN  NO EVENT SHALL  THE COPYRIGHT  OWNER  OR CONTRIBUTORS BE
+ | LIABLE  FOR  ANY  DIRECT,   INDIRECT,  INCIDENTAL,   SPECIAL,  EXEMPLARY,  OR
+ | CONSEQUENTIAL   DAMAGES  (INCLUDING,  BUT  NOT  LIMITED  TO,  PROCUREMENT  OF
+ | SUBSTITUTE GOODS OR SERVICES;  LOSS  OF USE,  DATA,  OR PROFITS;  OR BUSINESS
+ | INTERRUPTION)  HOWEVER  CAUSED  AND ON  ANY  THEORY OF LIABILITY,  WHETHER IN
+ | CONTRACT,  STRICT  LIABILITY, OR  TORT (INCLUDING  NEGLIGENCE  OR  OTHERWISE)
+ | ARISING IN ANY  WAY OUT OF  THE USE OF THIS SOFTWARE, EVEN  IF ADVISED OF THE
+ | POSSIBILITY OF SUCH DAMAGE.
+ +~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~*/
+
+/* These are targeted multi-thread checks for features that the scenario
+ * matrix in unit.cpp doesn't exercise: read-to-write lock upgrades, deadlock
+ * detection with lock_auth_detecting, and write generations with stale_read
+ * validation. Each check reports one "check:" line; any logic failure exits
+ * nonzero, and a watchdog alarm catches a check that hangs (e.g., an actual
+ * deadlock that detection should have prevented).
+ */
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <signal.h>
+#include <unistd.h>
+
+#include "locking-container.hpp"
+//(necessary for non-template source)
+#include "locking-container.inc"
+
+#define SUCCESS        0
+#define ERROR_DEADLOCK 3
+#define ERROR_LOGIC    4
+
+//(generous: every check finishes in well under a second when healthy)
+#define WATCHDOG_SECONDS 60
+
+
+//typedefs
+
+typedef lc::locking_container <long> long_container;
+
+//(writers keep 'first' == 'second'; an optimistic reader seeing otherwise
+//has accepted a torn copy)
+struct long_pair {
+  long first, second;
+};
+
+typedef lc::locking_container <long_pair> pair_container;
+
+
+//helper functions
+
+static void watchdog_timeout(int /*sig*/) {
+  fprintf(stderr, "(watchdog timeout)\n");
+  exit(ERROR_DEADLOCK);
+}
+
+static void require(bool condition, const char *check, const char *what) {
+  if (condition) return;
+  fprintf(stderr, "%s: failed: %s\n", check, what);
+  exit(ERROR_LOGIC);
+}
+
+
+//read-to-write upgrades (rw_lock)
+
+static void check_upgrade_semantics() {
+  const char *check = "upgrade semantics";
+  long_container value(10);
+
+  //an upgrade can't jump ahead of another reader without blocking
+  {
+    long_container::read_proxy first = value.get_read(), second = value.get_read();
+    long_container::write_proxy failed = first.upgrade(false);
+    require(!failed, check, "upgrade succeeded past another reader");
+    require((bool) first, check, "failed upgrade dropped the read lock");
+    second.clear();
+    long_container::write_proxy write = first.upgrade();
+    require((bool) write, check, "upgrade failed with no other readers");
+    require(!first, check, "upgrade left the read proxy engaged");
+    ++*write;
+  }
+  require(*value.get_read() == 11, check, "upgraded write was lost");
+  //everything was released again
+  require((bool) value.get_write(false), check, "a lock was leaked");
+  fprintf(stdout, "check:\t%s\tpassed\n", check);
+}
+
+static void check_upgrade_contended() {
+  const char *check = "contended upgrades";
+  static const int  thread_count = 4;
+  static const long attempts     = 5000;
+  long_container value(0);
+  std::atomic <long> successes(0);
+
+  std::vector <std::thread> workers;
+  for (int t = 0; t < thread_count; t++) {
+    workers.emplace_back([&value, &successes] {
+      for (long n = 0; n < attempts; n++) {
+        long_container::read_proxy read = value.get_read();
+        assert(read);
+        //NOTE: non-blocking, because two concurrent upgrades on one lock must
+        //never both be granted; losing the race just means trying again
+        long_container::write_proxy write = read.upgrade(false);
+        if (write) {
+          ++*write;
+          ++successes;
+        }
+      }
+    });
+  }
+  for (int t = 0; t < thread_count; t++) workers[t].join();
+
+  //every successful upgrade was an exclusive write; none were lost or doubled
+  require(*value.get_read() == successes.load(), check, "increments don't match upgrades");
+  //(an uncontended upgrade must always be granted)
+  long_container::read_proxy read = value.get_read();
+  require((bool) read.upgrade(false), check, "uncontended upgrade failed");
+  fprintf(stdout, "check:\t%s\tpassed\n", check);
+}
+
+
+//deadlock detection (lock_auth_detecting)
+
+static void check_cycle_detection() {
+  const char *check = "cycle detection";
+  static const int  thread_count = 4;
+  static const long target       = 1000;
+  //every thread write-locks the full set, each starting at a different
+  //container, so blocking unchecked would deadlock almost immediately
+  long_container values[thread_count];
+  std::atomic <long> rejections(0);
+  //(simple spin barrier so the rings actually overlap)
+  std::atomic <int> start_barrier(thread_count);
+
+  std::vector <std::thread> workers;
+  for (int t = 0; t < thread_count; t++) {
+    workers.emplace_back([t, &values, &rejections, &start_barrier] {
+      lc::lock_auth_base::auth_type auth(new lc::lock_auth_detecting);
+      --start_barrier;
+      while (start_barrier.load() > 0) std::this_thread::yield();
+      for (long done = 0; done < target;) {
+        std::vector <long_container::write_proxy> held;
+        bool acquired = true;
+        for (int i = 0; i < thread_count; i++) {
+          held.push_back(values[(t + i) % thread_count].get_write_auth(auth));
+          if (!held.back()) {
+            //(detection turned a would-deadlock block into a rejection)
+            ++rejections;
+            acquired = false;
+            break;
+          }
+          //(give the other threads a chance to close the ring)
+          if (i == 0) std::this_thread::yield();
+        }
+        if (!acquired) continue; //(releases everything held so far)
+        for (int i = 0; i < thread_count; i++) ++*held[i];
+        ++done;
+      }
+    });
+  }
+  for (int t = 0; t < thread_count; t++) workers[t].join();
+
+  //reaching this point at all means no deadlock; verify nothing was torn
+  for (int i = 0; i < thread_count; i++) {
+    require(*values[i].get_read() == thread_count * target, check,
+      "increments were lost");
+  }
+  //(with the rings overlapping, detection must have intervened at least once)
+  require(rejections.load() > 0, check, "no near-deadlock was ever detected");
+  fprintf(stdout, "check:\t%s\tpassed (%ld rejections)\n", check, rejections.load());
+}
+
+
+//write generations and stale_read (rw_lock)
+
+static void check_generations() {
+  const char *check = "write generations";
+  long_container value(0);
+
+  lc::lock_auth_base::count_type before = value.get_generation();
+  require(before >= 0 && !(before & 1), check, "generation odd while unlocked");
+  {
+    long_container::write_proxy write = value.get_write();
+    require(value.get_generation() & 1, check, "generation even during a write");
+  }
+  require(value.get_generation() > before, check, "write didn't advance the generation");
+  require(!(value.get_generation() & 1), check, "generation odd after unlock");
+
+  //a view is invalidated by a write...
+  lc::stale_read <long> view = value.get_stale_read();
+  require((bool) view && view.revalidate(), check, "fresh view didn't validate");
+  value.get_write().clear();
+  require(!view.revalidate(), check, "view survived a write");
+  //...and by an upgrade, even before the writer modifies anything
+  view = value.get_stale_read();
+  {
+    long_container::read_proxy read = value.get_read();
+    require(view.revalidate(), check, "view invalidated by a read");
+    long_container::write_proxy write = read.upgrade();
+    require((bool) write, check, "upgrade failed with no other readers");
+    require(!view.revalidate(), check, "view survived an upgrade");
+  }
+  //locks without generations decline the view instead of misvalidating it
+  lc::locking_container <long, lc::dumb_lock> dumb(0);
+  require(!dumb.get_stale_read(), check, "view granted without generations");
+  fprintf(stdout, "check:\t%s\tpassed\n", check);
+}
+
+static void check_stale_read_torn() {
+  const char *check = "stale_read consistency";
+  static const long writes = 5000;
+  long_pair initial = { 0, 0 };
+  pair_container value(initial);
+  std::atomic <bool> done(false);
+
+  std::thread writer([&value, &done] {
+    for (long n = 1; n <= writes; n++) {
+      {
+        pair_container::write_proxy write = value.get_write();
+        assert(write);
+        write->first  = n;
+        write->second = n;
+      }
+      //(writes are occasional relative to the readers' validation loops)
+      std::this_thread::yield();
+    }
+    done.store(true);
+  });
+
+  long validated = 0;
+  while (!done.load()) {
+    lc::stale_read <long_pair> view = value.get_stale_read();
+    if (!view) continue; //(the writer was mid-update)
+    long_pair copy;
+    if (!view.read_copy(copy)) continue; //(invalidated; retry)
+    require(copy.first == copy.second, check, "validated copy was torn");
+    ++validated;
+  }
+  writer.join();
+  require(validated > 0, check, "no reads ever validated");
+  fprintf(stdout, "check:\t%s\tpassed (%ld validated)\n", check, validated);
+}
+
+
+//the program proper
+
+int main() {
+  signal(SIGALRM, &watchdog_timeout);
+  alarm(WATCHDOG_SECONDS);
+
+  check_upgrade_semantics();
+  check_upgrade_contended();
+  check_cycle_detection();
+  check_generations();
+  check_stale_read_torn();
+
+  return SUCCESS;
+}
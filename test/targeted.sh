@@ -0,0 +1,31 @@
+#!/usr/bin/env bash
+
+#builds and runs the targeted multi-thread checks in targeted.cpp. these are
+#pass/fail; run unit.sh for the full scenario matrix.
+
+comp='c++ -Wall -pedantic -std=c++11 -g -O2 -I../include targeted.cpp -o targeted -lpthread'
+prog='./targeted'
+
+exit_names=(
+  'SUCCESS'
+  ''
+  ''
+  'ERROR_DEADLOCK'
+  'ERROR_LOGIC'
+)
+
+cd "$(dirname "$0")" || exit 1
+
+echo "// $comp //"
+eval $comp || exit 1
+
+echo "// $prog //"
+$prog
+result=$?
+[ "${exit_names[$result]}" ] && result="${exit_names[$result]}"
+if [ "$result" = "${exit_names[0]}" ]; then
+  echo "PASSED [exit: $result]"
+else
+  echo "FAILED [exit: $result]"
+  exit 1
+fi
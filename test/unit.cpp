@@ -37,6 +37,7 @@
 
 #include <vector>
 #include <memory>
+#include <new>
 
 #include <time.h>
 #include <errno.h>
@@ -230,6 +231,28 @@ protected:
 
 //helper functions
 
+//NOTE: 'fast_rw_lock', 'fifo_rw_lock', and 'fast_meta_lock' are over-aligned
+//for cache-line separation, and C++11 'new' doesn't honor extended alignment
+//(see the attention note on 'padded_lock'), so they're allocated manually
+
+template <class Type>
+struct aligned_delete {
+  void operator () (Type *object) const {
+    if (!object) return;
+    object->~Type();
+    free(object);
+  }
+};
+
+template <class Type, class ... Args>
+static std::shared_ptr <Type> new_aligned(Args ... args) {
+  static const size_t alignment =
+    (alignof(Type) < alignof(void*))? alignof(void*) : alignof(Type);
+  void *memory = NULL;
+  if (posix_memalign(&memory, alignment, sizeof(Type)) != 0) exit(ERROR_SYSTEM);
+  return std::shared_ptr <Type> (new(memory) Type(args...), aligned_delete <Type> ());
+}
+
 static int print_help(const char *name, const char *message = NULL);
 
 static void deadlock_timeout(int sig);
@@ -265,7 +288,7 @@ int main(int argc, char *argv[]) {
   if (sscanf(argv[3], "%i%c", &try_deadlock, &error) != 1 || try_deadlock < 0 || try_deadlock > 1)
     return print_help(argv[0], "invalid deadlock value");
 
-  if (sscanf(argv[4], "%i%c", &lock_type, &error) != 1 || lock_type < 0 || lock_type > 3)
+  if (sscanf(argv[4], "%i%c", &lock_type, &error) != 1 || lock_type < 0 || lock_type > 4)
     return print_help(argv[0], "invalid lock type");
 
   if (sscanf(argv[5], "%i%c", &auth_type, &error) != 1 || auth_type < 0 || auth_type > 4)
@@ -280,14 +303,19 @@ int main(int argc, char *argv[]) {
   if (lock_method == 3 && auth_type < 2)
     return print_help(argv[0], "auth type must be >= 2 with ordered locks");
 
-  if (lock_method == 2 && try_deadlock)
+  if (lock_method == 3 && lock_type == 4)
+    return print_help(argv[0], "policy locks cannot be used with ordered locking");
+
+  if ((lock_method == 2 || lock_method == 4) && try_deadlock)
     return print_help(argv[0], "cannot cause a deadlock with multi-locking");
 
   //program data
 
   philosopher_set   all_philosophers(thread_count);
   chopstick_set     all_chopsticks(thread_count);
-  lc::shared_meta_lock multi((lock_method == 2)? new lc::meta_lock : NULL);
+  lc::shared_meta_lock multi;
+  if (lock_method == 2) multi.reset(new lc::meta_lock);
+  if (lock_method == 4) multi = new_aligned <lc::fast_meta_lock> ();
   thread_set        all_threads(thread_count);
   pthread_barrier_t barrier;
   struct timespec   start, finish;
@@ -341,6 +369,7 @@ static int print_help(const char *name, const char *message) {
   fprintf(stderr, "  1: authorization only\n");
   fprintf(stderr, "  2: multi-locking\n");
   fprintf(stderr, "  3: ordered locking\n");
+  fprintf(stderr, "  4: multi-locking (fast_meta_lock)\n");
   fprintf(stderr, "[deadlock?]: attempt to cause a deadlock?\n");
   fprintf(stderr, "  0: no\n");
   fprintf(stderr, "  1: yes\n");
@@ -348,11 +377,14 @@ static int print_help(const char *name, const char *message) {
   fprintf(stderr, "  0: rw_lock\n");
   fprintf(stderr, "  1: w_lock\n");
   fprintf(stderr, "  2: dumb_lock\n");
+  fprintf(stderr, "  3: fast_rw_lock\n");
+  fprintf(stderr, "  4: fifo_rw_lock\n");
   fprintf(stderr, "[auth type]: type of authorization objects to use\n");
   fprintf(stderr, "  0: rw_lock\n");
   fprintf(stderr, "  1: w_lock\n");
   fprintf(stderr, "  2: ordered_lock <rw_lock>\n");
   fprintf(stderr, "  3: ordered_lock <w_lock>\n");
+  fprintf(stderr, "  4: lock_auth_detecting\n");
   fprintf(stderr, "(timeout): time (in seconds) to wait for deadlock (default: 1s)\n");
   return ERROR_ARGS;
 }
@@ -370,19 +402,23 @@ static void init_chopsticks(int lock_method, int lock_type, chopstick_set &chops
       case 0:
       case 1:
       case 2:
+      case 4:
         switch (lock_type) {
-          case 0: chops[i].reset(new lc::locking_container <chopstick, lc::rw_lock>);   break;
-          case 1: chops[i].reset(new lc::locking_container <chopstick, lc::w_lock>);    break;
-          case 2: chops[i].reset(new lc::locking_container <chopstick, lc::dumb_lock>); break;
+          case 0: chops[i].reset(new lc::locking_container <chopstick, lc::rw_lock>);      break;
+          case 1: chops[i].reset(new lc::locking_container <chopstick, lc::w_lock>);       break;
+          case 2: chops[i].reset(new lc::locking_container <chopstick, lc::dumb_lock>);    break;
+          case 3: chops[i] = new_aligned <lc::locking_container <chopstick, lc::fast_rw_lock> > (); break;
+          case 4: chops[i] = new_aligned <lc::locking_container <chopstick, lc::fifo_rw_lock> > (); break;
           default: exit(ERROR_ARGS); break;
         }
         break;
       case 3:
         switch (lock_type) {
           //NOTE: lock order must be > 0 for order rules to apply
-          case 0: chops[i].reset(new lc::locking_container <chopstick, lc::ordered_lock <lc::rw_lock> >   (chopstick(), i + 1)); break;
-          case 1: chops[i].reset(new lc::locking_container <chopstick, lc::ordered_lock <lc::w_lock> >    (chopstick(), i + 1)); break;
-          case 2: chops[i].reset(new lc::locking_container <chopstick, lc::ordered_lock <lc::dumb_lock> > (chopstick(), i + 1)); break;
+          case 0: chops[i].reset(new lc::locking_container <chopstick, lc::ordered_lock <lc::rw_lock> >      (chopstick(), i + 1)); break;
+          case 1: chops[i].reset(new lc::locking_container <chopstick, lc::ordered_lock <lc::w_lock> >       (chopstick(), i + 1)); break;
+          case 2: chops[i].reset(new lc::locking_container <chopstick, lc::ordered_lock <lc::dumb_lock> >    (chopstick(), i + 1)); break;
+          case 3: chops[i] = new_aligned <lc::locking_container <chopstick, lc::ordered_lock <lc::fast_rw_lock> > > (chopstick(), i + 1); break;
           default: exit(ERROR_ARGS); break;
         }
         break;
@@ -402,11 +438,13 @@ static void init_philosophers(int lock_method, int auth_type, chopstick_set &cho
       case 0: break; //(no auth. used)
       case 1:
       case 2:
+      case 4:
         switch (auth_type) {
           case 0: new_auth.reset(new lc::lock_auth <lc::rw_lock>); break;
           case 1: new_auth.reset(new lc::lock_auth <lc::w_lock>);  break;
           case 2: new_auth.reset(new lc::lock_auth <lc::ordered_lock <lc::rw_lock> >); break;
           case 3: new_auth.reset(new lc::lock_auth <lc::ordered_lock <lc::w_lock> >);  break;
+          case 4: new_auth.reset(new lc::lock_auth_detecting); break;
           default: exit(ERROR_ARGS); break;
         }
         break;
@@ -416,6 +454,8 @@ static void init_philosophers(int lock_method, int auth_type, chopstick_set &cho
           case 1: exit(ERROR_ARGS); break;
           case 2: new_auth.reset(new lc::lock_auth <lc::ordered_lock <lc::rw_lock> >); break;
           case 3: new_auth.reset(new lc::lock_auth <lc::ordered_lock <lc::w_lock> >);  break;
+          //(orders are ignored by detection, so ordered containers are fine)
+          case 4: new_auth.reset(new lc::lock_auth_detecting); break;
           default: exit(ERROR_ARGS); break;
         }
         break;
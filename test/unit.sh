@@ -3,22 +3,25 @@
 comp='c++ -Wall -pedantic -std=c++11 -g -O2 -I../include unit.cpp -o unit -lpthread'
 prog='./unit'
 threads='2 4 8 16 256'
-methods='0 1 2 3'
+methods='0 1 2 3 4'
 deadlocks='0 1'
-locks='0 1 2'
-auths='0 1 2 3'
+locks='0 1 2 3 4'
+auths='0 1 2 3 4'
 
 method_names=(
   'unsafe'
   'auth'
   'multi'
   'ordered'
+  'multi (fast)'
 )
 
 lock_names=(
   'rw_lock'
   'w_lock'
   'dumb_lock'
+  'fast_rw_lock'
+  'fifo_rw_lock'
 )
 
 deadlock_names=(
@@ -31,6 +34,7 @@ auth_names=(
   'w_lock'
   'ordered_lock <rw_lock>'
   'ordered_lock <w_lock>'
+  'lock_auth_detecting'
   '(none)'
 )
 
@@ -54,8 +58,10 @@ expected_result() {
   [ "$m" -eq 0 ] && [ "$a" -gt 0 ] && return 1
   #ordered locks without ordered auth.
   [ "$m" -eq 3 ] && [ "$a" -lt 2 ] && return 1
+  #ordered policy locks (no ordered auth. specialization for them)
+  [ "$m" -eq 3 ] && [ "$l" -eq 4 ] && return 1
   #trying to cause a deadlock with multi-locking
-  [ "$m" -eq 2 ] && [ "$d" -ne 0 ] && return 1
+  { [ "$m" -eq 2 ] || [ "$m" -eq 4 ]; } && [ "$d" -ne 0 ] && return 1
   #unsafe locking
   [ "$m" -eq 0 ] && return 3
   return 0